@@ -15,6 +15,8 @@
 #include <imageprocessing/io/ImageStackDirectoryReader.h>
 #include <volumes/io/Hdf5VolumeStore.h>
 #include <volumes/ExtractLabels.h>
+#include <volumes/ImageStackIngest.h>
+#include <volumes/VolumePyramid.h>
 
 util::ProgramOption optionIntensities(
 		util::_long_name        = "intensities",
@@ -44,47 +46,57 @@ int main(int argc, char** argv) {
 		util::ProgramOptions::init(argc, argv);
 		logger::LogManager::init();
 
-		pipeline::Process<ImageStackDirectoryReader> intensityReader(optionIntensities.as<std::string>());
-		pipeline::Process<ImageStackDirectoryReader> labelReader(optionLabels.as<std::string>());
-
-		pipeline::Value<ImageStack> intensityStack = intensityReader->getOutput();
-		pipeline::Value<ImageStack> labelStack = labelReader->getOutput();
+		if (!optionExtractLabels) {
 
-		if (optionExtractLabels) {
+			// the stacks are streamed slab by slab into the project file, the 
+			// levels of the volume pyramid are built from the same slabs
 
-			LOG_DEBUG(logger::out) << "[main] extracting labels from connected components" << std::endl;
+			createProjectVolumes(
+					optionProjectFile.as<std::string>(),
+					optionIntensities.as<std::string>(),
+					optionLabels.as<std::string>());
 
-			pipeline::Process<ExtractLabels> extractLabels;
-			extractLabels->setInput(labelReader->getOutput());
-			labelStack = extractLabels->getOutput();
+			return 0;
 		}
 
-		unsigned int width  = labelStack->width();
-		unsigned int height = labelStack->height();
-		unsigned int depth  = labelStack->size();
+		ImageStackIngest intensityIngest(optionIntensities.as<std::string>());
+		vigra::Shape3    shape = intensityIngest.getShape();
 
-		if (width  != intensityStack->width() ||
-			height != intensityStack->height() ||
-			depth  != intensityStack->size())
-			UTIL_THROW_EXCEPTION(
-					UsageError,
-					"intensity and label stacks have different sizes");
+		boost::filesystem::remove(optionProjectFile.as<std::string>());
+		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
 
-		// create volumes from stacks
+		// connected components need the whole label stack in memory
 
-		ExplicitVolume<float> intensities(*intensityStack);
-		ExplicitVolume<int>   labels(*labelStack);
+		LOG_DEBUG(logger::out) << "[main] extracting labels from connected components" << std::endl;
 
-		intensities.normalize();
+		pipeline::Process<ImageStackDirectoryReader> labelReader(optionLabels.as<std::string>());
+		pipeline::Process<ExtractLabels>             extractLabels;
+		extractLabels->setInput(labelReader->getOutput());
 
-		// store them in the project file
+		pipeline::Value<ImageStack> labelStack = extractLabels->getOutput();
 
-		boost::filesystem::remove(optionProjectFile.as<std::string>());
-		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
+		if (vigra::Shape3(labelStack->width(), labelStack->height(), labelStack->size()) != shape)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"intensity and label stacks have different sizes");
 
-		volumeStore.saveIntensities(intensities);
+		ExplicitVolume<int> labels(*labelStack);
 		volumeStore.saveLabels(labels);
 
+		VolumePyramidBuilder<int> pyramid(
+				volumeStore,
+				labels.data().shape(),
+				labels.getResolution(),
+				labels.getOffset(),
+				getNumPyramidLevels());
+		pyramid.addSlab(labels.data());
+		pyramid.finish();
+
+		// the volumes are not marked complete, the labels do not match the 
+		// label images that tube_pipeline would read
+
+		intensityIngest.ingestIntensities(volumeStore, getNumPyramidLevels());
+
 	} catch (boost::exception& e) {
 
 		handleException(e, std::cerr);
@@ -4,11 +4,13 @@
  */
 
 #include <iostream>
+#include <fstream>
 
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include <util/exceptions.h>
 #include <tubes/io/Hdf5TubeStore.h>
+#include <tubes/io/SkeletonExport.h>
 
 util::ProgramOption optionProjectFile(
 		util::_long_name        = "projectFile",
@@ -34,9 +36,9 @@ int main(int argc, char** argv) {
 		util::ProgramOptions::init(argc, argv);
 		logger::LogManager::init();
 
-		// create an hdf5 tube store
+		// create a read-only hdf5 tube store
 
-		Hdf5TubeStore tubeStore(optionProjectFile.as<std::string>());
+		Hdf5TubeStore tubeStore(optionProjectFile.as<std::string>(), true);
 
 		TubeIds ids;
 
@@ -67,76 +69,8 @@ int main(int argc, char** argv) {
 
 		for (TubeId id : ids) {
 
-			std::ofstream skeletonfile(std::string("skeleton_") + boost::lexical_cast<std::string>(id) + (vtk ? ".vtk" : ".txt"));
-
-			if (vtk) {
-
-				skeletonfile << "# vtk DataFile Version 3.0" << std::endl;
-				skeletonfile << "vtk output" << std::endl;
-				skeletonfile << "ASCII" << std::endl;
-				skeletonfile << "DATASET UNDIRECTED_GRAPH" << std::endl;
-			}
-
-			const Skeleton& skeleton = skeletons[id];
-
-			int numNodes = 0;
-			int numEdges = 0;
-			for (Skeleton::Graph::NodeIt node(skeleton.graph()); node != lemon::INVALID; ++node)
-				numNodes++;
-			for (Skeleton::Graph::EdgeIt edge(skeleton.graph()); edge != lemon::INVALID; ++edge)
-				numEdges++;
-
-			// nodes (number of)
-
-			if (vtk)
-				skeletonfile << "POINTS " << numNodes << " float" << std::endl;
-			else
-				skeletonfile << numNodes << std::endl;
-
-			// node positions (node x y z)
-			for (int nodeId = 0; nodeId < numNodes; nodeId++) {
-
-				Skeleton::Graph::Node node = skeleton.graph().nodeFromId(nodeId);
-
-				if (!vtk)
-					skeletonfile
-							<< skeleton.graph().id(node) << "\t";
-
-				util::point<float, 3> pos = skeleton.positions()[node];
-				pos = pos*skeleton.getResolution() + skeleton.getOffset();
-
-				skeletonfile
-						<< pos.x() << " "
-						<< pos.y() << " "
-						<< pos.z() << std::endl;
-			}
-
-			if (vtk) {
-
-				skeletonfile << "VERTICES " << numNodes << std::endl;
-				skeletonfile << "EDGES " << numEdges << std::endl;
-			}
-
-			// edges (pairs of nodes)
-
-			for (Skeleton::Graph::EdgeIt edge(skeleton.graph()); edge != lemon::INVALID; ++edge)
-				skeletonfile
-						<< skeleton.graph().id(skeleton.graph().u(edge)) << " "
-						<< skeleton.graph().id(skeleton.graph().v(edge)) << std::endl;
-
-			// node diameters (node d)
-
-			if (vtk) {
-
-				skeletonfile << "VERTEX_DATA " << numNodes << std::endl;
-				skeletonfile << "FIELD FieldData 1" << std::endl;
-				skeletonfile << "diameters 1 " << numNodes << " double" << std::endl;
-			}
-			for (int nodeId = 0; nodeId < numNodes; nodeId++) {
-
-				Skeleton::Graph::Node node = skeleton.graph().nodeFromId(nodeId);
-				skeletonfile << skeleton.diameters()[node] << std::endl;
-			}
+			std::ofstream skeletonfile(getSkeletonExportFilename(id, vtk));
+			exportSkeleton(skeletons[id], skeletonfile, vtk);
 		}
 
 	} catch (boost::exception& e) {
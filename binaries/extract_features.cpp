@@ -24,6 +24,12 @@ util::ProgramOption optionSkeletonsOnly(
 		util::_long_name        = "skeletonsOnly",
 		util::_description_text = "Don't extract other features, only the skeletons of the tubes.");
 
+util::ProgramOption optionFeaturesFromTubes(
+		util::_long_name        = "featuresFromTubes",
+		util::_description_text = "Compute the features on the tube volumes in the project file, instead of on the label volume. "
+		                          "The features of different tubes are computed in parallel, and the label volume is not read. Tubes are "
+		                          "processed in batches of featureSaveBatchSize, reading only the intensities each tube covers.");
+
 int main(int argc, char** argv) {
 
 	try {
@@ -31,27 +37,36 @@ int main(int argc, char** argv) {
 		util::ProgramOptions::init(argc, argv);
 		logger::LogManager::init();
 
-		// read the label and intensity volumes
-
-		ExplicitVolume<float> intensities;
-		ExplicitVolume<int>   labels;
-
-		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
-		volumeStore.retrieveIntensities(intensities);
-		volumeStore.retrieveLabels(labels);
-
 		// create an hdf5 tube store
 
 		Hdf5TubeStore tubeStore(optionProjectFile.as<std::string>());
 
 		if (!optionSkeletonsOnly) {
 
-			// extract and save tube features
-
-			LOG_USER(logger::out) << "extracting features..." << std::endl;
+			Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
 
 			FeatureExtractor featureExtractor(&tubeStore);
-			featureExtractor.extractFrom(intensities, labels);
+
+			if (optionFeaturesFromTubes) {
+
+				// tubes are read in batches, together with the intensities 
+				// each of them covers
+
+				LOG_USER(logger::out) << "extracting features..." << std::endl;
+
+				featureExtractor.extractFrom(volumeStore, tubeStore.getTubeIds());
+
+			} else {
+
+				ExplicitVolume<float> intensities;
+				ExplicitVolume<int>   labels;
+				volumeStore.retrieveIntensities(intensities);
+				volumeStore.retrieveLabels(labels);
+
+				LOG_USER(logger::out) << "extracting features..." << std::endl;
+
+				featureExtractor.extractFrom(intensities, labels);
+			}
 		}
 
 		// extract and save tube skeletons
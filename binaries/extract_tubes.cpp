@@ -25,30 +25,49 @@ util::ProgramOption optionTubeId(
 		util::_short_name       = "i",
 		util::_description_text = "The ids of the tubes to extract (separated by a single non-decimal character). If not given, all tubes are extracted.");
 
-int main(int argc, char** argv) {
+util::ProgramOption optionBlockSize(
+		util::_long_name        = "blockSize",
+		util::_description_text = "Don't read the whole label volume into memory, but process it in blocks of this size (in voxels, "
+		                          "either one value for all dimensions or three values separated by a single non-decimal character).");
 
-	try {
+vigra::Shape3 parseBlockShape(std::string value) {
 
-		util::ProgramOptions::init(argc, argv);
-		logger::LogManager::init();
+	std::vector<int> sizes;
+	std::stringstream ss(value);
 
-		// read the label volume
+	while (ss.good()) {
 
-		ExplicitVolume<int> labels;
+		int size;
+		ss >> size;
+		sizes.push_back(size);
 
-		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
-		volumeStore.retrieveLabels(labels);
+		char sep;
+		if (ss.good())
+			ss >> sep;
+	}
 
-		Hdf5TubeStore store(optionProjectFile.as<std::string>());
-		TubeExtractor extractor(&store);
+	if (sizes.size() == 1)
+		sizes.resize(3, sizes[0]);
 
-		if (!optionTubeId) {
+	if (sizes.size() != 3 || sizes[0] <= 0 || sizes[1] <= 0 || sizes[2] <= 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"invalid block size " << value);
 
-			extractor.extractFrom(labels);
+	return vigra::Shape3(sizes[0], sizes[1], sizes[2]);
+}
 
-		} else {
+int main(int argc, char** argv) {
+
+	try {
+
+		util::ProgramOptions::init(argc, argv);
+		logger::LogManager::init();
+
+		TubeIdSet ids;
+
+		if (optionTubeId) {
 
-			std::set<TubeId> ids;
 			std::stringstream ss(optionTubeId.as<std::string>());
 
 			while (ss.good()) {
@@ -61,11 +80,29 @@ int main(int argc, char** argv) {
 				if (ss.good())
 					ss >> sep;
 			}
+		}
+
+		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
+		Hdf5TubeStore   store(optionProjectFile.as<std::string>());
+		TubeExtractor   extractor(&store);
+
+		if (optionBlockSize) {
+
+			extractor.extractFrom(
+					volumeStore,
+					parseBlockShape(optionBlockSize.as<std::string>()),
+					ids);
+
+		} else {
+
+			// read the label volume
+
+			ExplicitVolume<int> labels;
+			volumeStore.retrieveLabels(labels);
 
 			extractor.extractFrom(labels, ids);
 		}
 
-
 	} catch (boost::exception& e) {
 
 		handleException(e, std::cerr);
@@ -1,9 +1,11 @@
 #include <iostream>
+#include <memory>
 
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 
 #include <graph/Graph.h>
+#include <graph/MemoryUsage.h>
 #include <graph/RandomWeightedGraphGenerator.h>
 #include <io/WeightedGraphReader.h>
 #include <io/WeightedGraphWriter.h>
@@ -12,6 +14,10 @@
 #include <inference/ExplicitWeightTerm.h>
 #include <inference/CandidateConflictTerm.h>
 #include <inference/MultiEdgeFactorTerm.h>
+#include <inference/MemoryEstimate.h>
+#include <inference/GraphReduction.h>
+#include <solver/BatchSolver.h>
+#include <solver/SolveServer.h>
 
 util::ProgramOption optionGraphFile(
 		util::_long_name        = "graph",
@@ -50,18 +56,138 @@ util::ProgramOption optionRandomGraphMaxWeight(
 
 util::ProgramOption optionWriteResult(
 		util::_long_name        = "writeResult",
-		util::_description_text = "Write the resulting MST as a graph to the given file.");
+		util::_description_text = "Write the resulting MST as a graph to the given file. The format is chosen by the extension: "
+		                          "'.lgf' (lemon graph format), '.bin' (binary, selected arcs only), or GUESS otherwise. "
+		                          "Append '.gz' to compress the output.");
 
 util::ProgramOption optionNumIterations(
 		util::_long_name        = "numIterations",
 		util::_description_text = "The maximal number of iterations for finding the HOST.",
 		util::_default_value    = 100);
 
+util::ProgramOption optionBatch(
+		util::_long_name        = "batch",
+		util::_short_name       = "b",
+		util::_description_text = "Solve all graphs listed in the given manifest file (one '<graph file> [<factor file>]' per line) "
+		                          "or contained in the given directory (*.dat and *.lgf, with optional <name>_factors.dat).");
+
+util::ProgramOption optionBatchResults(
+		util::_long_name        = "batchResults",
+		util::_description_text = "A directory to store the results of a batch run. If not given, results are not written.");
+
+util::ProgramOption optionBatchResultSuffix(
+		util::_long_name        = "batchResultSuffix",
+		util::_description_text = "The suffix to append to the graph file names for the results of a batch run, determines the format "
+		                          "(see option writeResult).",
+		util::_default_value    = ".bin");
+
+util::ProgramOption optionNumThreads(
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of worker threads for a batch run. 0 uses one thread per core.",
+		util::_default_value    = 0);
+
+util::ProgramOption optionServe(
+		util::_long_name        = "serve",
+		util::_description_text = "Keep the graph given by option graph in memory and process requests on a Unix domain socket "
+		                          "with the given path (see host_client).");
+
+util::ProgramOption optionReportMemory(
+		util::_long_name        = "reportMemory",
+		util::_description_text = "Print an estimate of the memory needed before solving, and a breakdown of the memory used "
+		                          "by the graph, its maps, and the terms after solving.");
+
+util::ProgramOption optionMaxMemory(
+		util::_long_name        = "maxMemory",
+		util::_description_text = "Estimate the memory needed for the given graph and factors before reading them, and refuse "
+		                          "to solve if more than this number of MB would be needed.");
+
+util::ProgramOption optionReduce(
+		util::_long_name        = "reduce",
+		util::_description_text = "Before searching, remove nodes that can not be reached from the root and dominated parallel arcs, "
+		                          "and contract arcs that are part of every arborescence.");
+
+/**
+ * Estimate the memory needed to solve the problem given by the graph and 
+ * factor files, without reading them into memory.
+ */
+host::MemoryUsage estimateMemoryUsage() {
+
+	host::ProblemSize size;
+
+	host::WeightedGraphReader graphReader(optionGraphFile.as<std::string>());
+	graphReader.count(size.numNodes, size.numLinkArcs, size.numConflictArcs);
+
+	if (optionMultiEdgeFactorFile) {
+
+		host::MultiEdgeFactorReader factorReader(optionMultiEdgeFactorFile.as<std::string>());
+		factorReader.count(size.numFactors, size.numFactorEdges);
+	}
+
+	size.numIterations = optionNumIterations.as<unsigned int>();
+
+	return host::estimateMemoryUsage(size);
+}
+
+int solveBatch() {
+
+	host::BatchSolver batchSolver(
+			optionNumThreads.as<unsigned int>(),
+			optionNumIterations.as<unsigned int>());
+
+	batchSolver.addJobs(
+			optionBatch.as<std::string>(),
+			optionBatchResults ? optionBatchResults.as<std::string>() : std::string(),
+			optionBatchResultSuffix.as<std::string>());
+
+	unsigned int numFailed = batchSolver.solve();
+
+	batchSolver.printSummary(std::cout);
+
+	std::cout
+			<< "solved " << (batchSolver.getJobs().size() - numFailed)
+			<< " of " << batchSolver.getJobs().size() << " graphs" << std::endl;
+
+	return (numFailed == 0 ? 0 : 1);
+}
+
 int main(int argc, char** argv) {
 
 	util::ProgramOptions::init(argc, argv);
 	logger::LogManager::init();
 
+	if (optionBatch)
+		return solveBatch();
+
+	if (optionServe) {
+
+		host::SolveServer server(
+				optionGraphFile.as<std::string>(),
+				optionMultiEdgeFactorFile ? optionMultiEdgeFactorFile.as<std::string>() : std::string(),
+				optionNumIterations.as<unsigned int>());
+
+		server.serve(optionServe.as<std::string>());
+
+		return 0;
+	}
+
+	if (optionGraphFile && (optionReportMemory || optionMaxMemory)) {
+
+		host::MemoryUsage estimate = estimateMemoryUsage();
+
+		if (optionReportMemory)
+			std::cout << "estimated memory usage:" << std::endl << estimate;
+
+		if (optionMaxMemory && estimate.total() > optionMaxMemory.as<std::size_t>()*1024*1024) {
+
+			std::cerr
+					<< "estimated memory usage of " << estimate.total()/(1024*1024)
+					<< " MB exceeds the limit of " << optionMaxMemory.as<std::size_t>()
+					<< " MB" << std::endl;
+
+			return 2;
+		}
+	}
+
 	host::Graph            graph;
 	host::ArcWeights       arcWeights(graph);
 	host::ArcLabels        arcLabels(graph);
@@ -104,23 +230,61 @@ int main(int argc, char** argv) {
 					<< arcWeights[arc] << std::endl;
 	}
 
+	// the reduced problem, if requested
+	host::Graph            reducedGraph;
+	host::ArcWeights       reducedWeights(reducedGraph);
+	host::ArcLabels        reducedLabels(reducedGraph);
+	host::ArcTypes         reducedTypes(reducedGraph);
+	host::MultiEdgeFactors reducedFactors;
+
+	std::unique_ptr<host::GraphReduction> reduction;
+
+	if (optionReduce) {
+
+		reduction.reset(new host::GraphReduction(graph, arcWeights, arcLabels, arcTypes));
+
+		reduction->protect(multiEdgeFactors);
+		reduction->reduce(reducedGraph, reducedWeights, reducedLabels, reducedTypes);
+		reduction->reduceFactors(multiEdgeFactors, reducedFactors);
+
+		std::cout << reduction->getStatistics() << std::endl;
+	}
+
+	// the problem to search on
+	host::Graph&            searchGraph   = (optionReduce ? reducedGraph   : graph);
+	host::ArcWeights&       searchWeights = (optionReduce ? reducedWeights : arcWeights);
+	host::ArcTypes&         searchTypes   = (optionReduce ? reducedTypes   : arcTypes);
+	host::MultiEdgeFactors& searchFactors = (optionReduce ? reducedFactors : multiEdgeFactors);
+
 	// the minimal spanning tree
 	host::ArcSelection mst(graph);
+	host::ArcSelection searchMst(searchGraph);
 
 	// search the minimal spanning tree under consideration of conflicting 
 	// candidates
-	host::HostSearch hostSearch(graph);
+	host::HostSearch hostSearch(searchGraph);
 
-	host::ExplicitWeightTerm    weightTerm(graph, arcWeights);
-	host::CandidateConflictTerm cctTerm(graph, arcTypes);
-	host::MultiEdgeFactorTerm   mefTerm(graph, multiEdgeFactors);
+	host::ExplicitWeightTerm    weightTerm(searchGraph, searchWeights);
+	host::CandidateConflictTerm cctTerm(searchGraph, searchTypes);
+	host::MultiEdgeFactorTerm   mefTerm(searchGraph, searchFactors);
 
 	hostSearch.addTerm(&weightTerm);
 	hostSearch.addTerm(&cctTerm);
 	hostSearch.addTerm(&mefTerm);
 
 	double length;
-	bool constraintsFulfilled = hostSearch.find(mst, length, optionNumIterations.as<unsigned int>());
+	bool constraintsFulfilled = hostSearch.find(searchMst, length, optionNumIterations.as<unsigned int>());
+
+	if (optionReduce) {
+
+		reduction->expand(searchMst, mst);
+		length += reduction->getOffset();
+
+	} else {
+
+		for (host::ArcIt arc(graph); arc != lemon::INVALID; ++arc)
+			mst[arc] = searchMst[arc];
+	}
 
 	if (constraintsFulfilled)
 		std::cout << "found a minimal spanning tree that fulfills the constraints" << std::endl;
@@ -137,6 +301,35 @@ int main(int argc, char** argv) {
 
 	std::cout << "length of minimal spanning tree is " << length << std::endl;
 
+	if (optionReportMemory) {
+
+		host::MemoryUsage usage;
+
+		usage.add("graph",                  host::memoryUsage(graph));
+		usage.add("weights",                host::memoryUsage(graph, arcWeights));
+		usage.add("labels",                 host::memoryUsage(graph, arcLabels));
+		usage.add("types",                  host::memoryUsage(graph, arcTypes));
+		usage.add("mst",                    host::memoryUsage(graph, mst));
+
+		if (optionReduce) {
+
+			usage.add("reduced graph",   host::memoryUsage(reducedGraph));
+			usage.add("reduced weights", host::memoryUsage(reducedGraph, reducedWeights));
+			usage.add("reduced labels",  host::memoryUsage(reducedGraph, reducedLabels));
+			usage.add("reduced types",   host::memoryUsage(reducedGraph, reducedTypes));
+			usage.add("reduced mst",     host::memoryUsage(reducedGraph, searchMst));
+		}
+
+		usage.add("conflict term",          cctTerm.memoryUsage());
+		usage.add("multi-edge factor term", mefTerm.memoryUsage());
+		hostSearch.memoryUsage(usage);
+
+		std::cout
+				<< "memory usage:" << std::endl << usage
+				<< "peak resident set size: "
+				<< host::MemoryUsage::peakResidentSetSize()/(1024*1024) << " MB" << std::endl;
+	}
+
 	if (optionWriteResult) {
 
 		host::WeightedGraphWriter graphWriter(optionWriteResult.as<std::string>());
@@ -0,0 +1,114 @@
+/**
+ * A small client for the solve server of host (see option --serve). Sends the
+ * request given on the command line, or each line read from stdin, and prints
+ * the responses.
+ */
+
+#include <iostream>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+
+util::ProgramOption optionSocket(
+		util::_long_name        = "socket",
+		util::_short_name       = "s",
+		util::_description_text = "The path of the socket the host server is listening on.",
+		util::_default_value    = "host.sock");
+
+util::ProgramOption optionRequest(
+		util::_long_name        = "request",
+		util::_short_name       = "r",
+		util::_description_text = "A single request to send, e.g., 'solve 500'. If not given, requests are read from stdin.");
+
+int connectTo(const std::string& socketPath) {
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	int connection = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if (connection < 0 || ::connect(connection, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not connect to " << socketPath << ": " << std::strerror(errno));
+
+	return connection;
+}
+
+/**
+ * Send a request and print the response. Returns false, if the connection was
+ * closed.
+ */
+bool sendRequest(int connection, std::string request, std::string& buffer) {
+
+	request += "\n";
+
+	if (::write(connection, request.c_str(), request.size()) != static_cast<ssize_t>(request.size()))
+		return false;
+
+	char chunk[4096];
+
+	while (true) {
+
+		std::size_t newline;
+		while ((newline = buffer.find('\n')) != std::string::npos) {
+
+			std::string line = buffer.substr(0, newline);
+			buffer.erase(0, newline + 1);
+
+			if (line == "end")
+				return true;
+
+			std::cout << line << std::endl;
+		}
+
+		ssize_t n = ::read(connection, chunk, sizeof(chunk));
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return false;
+
+		buffer.append(chunk, n);
+	}
+}
+
+int main(int argc, char** argv) {
+
+	try {
+
+		util::ProgramOptions::init(argc, argv);
+		logger::LogManager::init();
+
+		int connection = connectTo(optionSocket.as<std::string>());
+
+		std::string buffer;
+
+		if (optionRequest) {
+
+			sendRequest(connection, optionRequest.as<std::string>(), buffer);
+
+		} else {
+
+			std::string line;
+			while (std::getline(std::cin, line))
+				if (!line.empty() && !sendRequest(connection, line, buffer))
+					break;
+		}
+
+		::close(connection);
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
@@ -0,0 +1,343 @@
+/**
+ * This program runs the whole tube pipeline on an intensity and a label image
+ * stack: it creates the project file (like create_project), extracts the tubes
+ * (like extract_tubes), their features and skeletons (like extract_features),
+ * and optionally exports the skeletons (like export_skeleton).
+ *
+ * Each stage marks its results in the project file as complete when it is
+ * done, and completed stages are skipped. The label and intensity volumes are
+ * read only once and shared between the stages, and features and skeletons are
+ * extracted at the same time.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <boost/filesystem.hpp>
+
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include <volumes/io/Hdf5File.h>
+#include <volumes/io/Hdf5VolumeStore.h>
+#include <volumes/ImageStackIngest.h>
+#include <tubes/io/Hdf5TubeStore.h>
+#include <tubes/io/ConcurrentTubeStore.h>
+#include <tubes/io/SkeletonExport.h>
+#include <tubes/TubeExtractor.h>
+#include <tubes/FeatureExtractor.h>
+#include <tubes/SkeletonExtractor.h>
+#include <tubes/StageRunner.h>
+
+util::ProgramOption optionProjectFile(
+		util::_long_name        = "projectFile",
+		util::_short_name       = "p",
+		util::_description_text = "The project file to create or update.",
+		util::_default_value    = "project.hdf");
+
+util::ProgramOption optionIntensities(
+		util::_long_name        = "intensities",
+		util::_description_text = "A directory containing the intensity volume. The project file is created again, if any image "
+		                          "in this directory changed since the project file was created.",
+		util::_default_value    = "intensities");
+
+util::ProgramOption optionLabels(
+		util::_long_name        = "labels",
+		util::_description_text = "A directory containing the labeled volume. The project file is created again, if any image "
+		                          "in this directory changed since the project file was created.",
+		util::_default_value    = "labels");
+
+util::ProgramOption optionExportSkeletons(
+		util::_long_name        = "exportSkeletons",
+		util::_description_text = "Export the skeletons of all tubes to the current directory, in the given format: 'vtk' (vtk "
+		                          "ASCII graph format) or 'txt' (simple text file).");
+
+util::ProgramOption optionForce(
+		util::_long_name        = "force",
+		util::_description_text = "Run all stages, even if their results are in the project file already.");
+
+logger::LogChannel tubepipelinelog("tubepipelinelog", "[tube_pipeline] ");
+
+/**
+ * The state shared between the stages of the pipeline.
+ *
+ * HDF5 can not be used from several threads at once. All accesses to the
+ * project file after it was created go through the I/O thread of a single
+ * ConcurrentTubeStore, including the reads of the label and intensity volumes.
+ */
+class Pipeline {
+
+public:
+
+	Pipeline(const std::string& projectFile) :
+		_projectFile(projectFile),
+		_haveIntensities(false),
+		_haveLabels(false) {}
+
+	bool volumesCurrent() {
+
+		if (!boost::filesystem::exists(_projectFile))
+			return false;
+
+		return isHdf5StageComplete(
+				openHdf5File(_projectFile, true),
+				"volumes",
+				getImageStacksStamp(
+						optionIntensities.as<std::string>(),
+						optionLabels.as<std::string>()));
+	}
+
+	void createVolumes() {
+
+		// this is the first stage, nothing else has the project file open
+		createProjectVolumes(
+				_projectFile,
+				optionIntensities.as<std::string>(),
+				optionLabels.as<std::string>());
+	}
+
+	bool tubesCurrent() {
+
+		return isComplete("tubes");
+	}
+
+	void extractTubes() {
+
+		clearComplete("tubes");
+
+		TubeExtractor extractor(&store());
+		extractor.extractFrom(labels());
+
+		setComplete("tubes");
+	}
+
+	bool featuresCurrent() {
+
+		return isComplete("features");
+	}
+
+	void extractFeatures() {
+
+		clearComplete("features");
+
+		FeatureExtractor extractor(&store());
+		extractor.extractFrom(intensities(), labels());
+
+		setComplete("features");
+	}
+
+	bool skeletonsCurrent() {
+
+		// complete even if some tubes have no skeleton (e.g., because no node 
+		// was found for them)
+		return isComplete("skeletons");
+	}
+
+	void extractSkeletons() {
+
+		clearComplete("skeletons");
+
+		// resumes where a previous run stopped
+		SkeletonExtractor extractor(&store());
+		extractor.extract();
+
+		setComplete("skeletons");
+	}
+
+	bool exportCurrent() {
+
+		bool vtk = (optionExportSkeletons.as<std::string>() == "vtk");
+
+		// tubes without a skeleton have no export file
+		for (TubeId id : store().getSkeletonizedTubeIds())
+			if (!boost::filesystem::exists(getSkeletonExportFilename(id, vtk)))
+				return false;
+
+		return true;
+	}
+
+	void exportSkeletons() {
+
+		bool vtk = (optionExportSkeletons.as<std::string>() == "vtk");
+
+		const std::size_t batchSize = 100;
+
+		// request the next batch of skeletons before writing the current one
+
+		std::vector<TubeIds> batches;
+		for (TubeId id : store().getSkeletonizedTubeIds()) {
+
+			if (batches.empty() || batches.back().size() == batchSize)
+				batches.push_back(TubeIds());
+			batches.back().add(id);
+		}
+
+		if (batches.empty())
+			return;
+
+		std::future<Skeletons> next = store().retrieveSkeletonsAsync(batches[0]);
+
+		for (std::size_t i = 0; i < batches.size(); i++) {
+
+			Skeletons skeletons = next.get();
+			if (i + 1 < batches.size())
+				next = store().retrieveSkeletonsAsync(batches[i + 1]);
+
+			for (auto& p : skeletons) {
+
+				std::ofstream file(getSkeletonExportFilename(p.first, vtk));
+				exportSkeleton(p.second, file, vtk);
+			}
+		}
+	}
+
+private:
+
+	// the tube store, opened when first needed (after the project file was
+	// created)
+	ConcurrentTubeStore& store() {
+
+		std::lock_guard<std::mutex> lock(_storeMutex);
+
+		if (!_store) {
+
+			_tubeStore.reset(new Hdf5TubeStore(_projectFile));
+			_store.reset(new ConcurrentTubeStore(_tubeStore.get()));
+
+			_store->submit([this]() { _volumeStore.reset(new Hdf5VolumeStore(_projectFile)); }).get();
+		}
+
+		return *_store;
+	}
+
+	// the completion marks of the stages, written on the I/O thread after all 
+	// results of a stage were written
+	bool isComplete(const std::string& stage) {
+
+		return store().submit([this, stage]() { return isHdf5StageComplete(_tubeStore->getFile(), stage); }).get();
+	}
+
+	void setComplete(const std::string& stage) {
+
+		store().submit([this, stage]() { setHdf5StageComplete(_tubeStore->getFile(), stage); }).get();
+	}
+
+	void clearComplete(const std::string& stage) {
+
+		store().submit([this, stage]() { clearHdf5StageComplete(_tubeStore->getFile(), stage); }).get();
+	}
+
+	// the volumes, read on the I/O thread when first needed
+	ExplicitVolume<float>& intensities() {
+
+		std::lock_guard<std::mutex> lock(_intensitiesMutex);
+
+		if (!_haveIntensities) {
+
+			ConcurrentTubeStore& s = store();
+			s.submit([this]() { _volumeStore->retrieveIntensities(_intensities); }).get();
+			_haveIntensities = true;
+		}
+
+		return _intensities;
+	}
+
+	ExplicitVolume<int>& labels() {
+
+		std::lock_guard<std::mutex> lock(_labelsMutex);
+
+		if (!_haveLabels) {
+
+			ConcurrentTubeStore& s = store();
+			s.submit([this]() { _volumeStore->retrieveLabels(_labels); }).get();
+			_haveLabels = true;
+		}
+
+		return _labels;
+	}
+
+	std::string _projectFile;
+
+	// destructed in reverse order, the I/O thread is stopped first
+	std::unique_ptr<Hdf5TubeStore>       _tubeStore;
+	std::unique_ptr<Hdf5VolumeStore>     _volumeStore;
+	std::unique_ptr<ConcurrentTubeStore> _store;
+	std::mutex                           _storeMutex;
+
+	ExplicitVolume<float> _intensities;
+	ExplicitVolume<int>   _labels;
+	bool                  _haveIntensities;
+	bool                  _haveLabels;
+	std::mutex            _intensitiesMutex;
+	std::mutex            _labelsMutex;
+};
+
+int main(int argc, char** argv) {
+
+	try {
+
+		util::ProgramOptions::init(argc, argv);
+		logger::LogManager::init();
+
+		Pipeline pipeline(optionProjectFile.as<std::string>());
+
+		// with --force, no stage is considered current
+		auto current = [](std::function<bool()> isCurrent) {
+
+			return [isCurrent]() { return !optionForce && isCurrent(); };
+		};
+
+		StageRunner runner;
+
+		runner.addStage(
+				"volumes",
+				{},
+				current([&]() { return pipeline.volumesCurrent(); }),
+				[&]() { pipeline.createVolumes(); });
+
+		runner.addStage(
+				"tubes",
+				{"volumes"},
+				current([&]() { return pipeline.tubesCurrent(); }),
+				[&]() { pipeline.extractTubes(); });
+
+		// features and skeletons only share the I/O thread, their computations
+		// overlap with each other's reads and writes
+
+		runner.addStage(
+				"features",
+				{"tubes"},
+				current([&]() { return pipeline.featuresCurrent(); }),
+				[&]() { pipeline.extractFeatures(); });
+
+		runner.addStage(
+				"skeletons",
+				{"tubes"},
+				current([&]() { return pipeline.skeletonsCurrent(); }),
+				[&]() { pipeline.extractSkeletons(); });
+
+		if (optionExportSkeletons) {
+
+			std::string format = optionExportSkeletons.as<std::string>();
+			if (format != "vtk" && format != "txt")
+				UTIL_THROW_EXCEPTION(
+						UsageError,
+						"unknown skeleton export format " << format);
+
+			runner.addStage(
+					"export",
+					{"skeletons"},
+					current([&]() { return pipeline.exportCurrent(); }),
+					[&]() { pipeline.exportSkeletons(); });
+		}
+
+		runner.run();
+
+		LOG_USER(tubepipelinelog) << "all stages done" << std::endl;
+
+	} catch (boost::exception& e) {
+
+		handleException(e, std::cerr);
+	}
+}
@@ -8,6 +8,7 @@
 #include <tubes/gui/MeshViewController.h>
 #include <tubes/gui/SkeletonViewController.h>
 #include <tubes/io/Hdf5TubeStore.h>
+#include <tubes/io/CachingTubeStore.h>
 #include <volumes/io/Hdf5VolumeStore.h>
 #include <sg_gui/RotateView.h>
 #include <sg_gui/ZoomView.h>
@@ -26,6 +27,11 @@ util::ProgramOption optionTubeId(
 		util::_short_name       = "i",
 		util::_description_text = "The ids of the tubes to show initially (separated by a single non-decimal character). If set to 'all', all tubes are shown.");
 
+util::ProgramOption optionVolumeResolution(
+		util::_long_name        = "volumeResolution",
+		util::_description_text = "If all tubes are shown, show the intensity and label volumes at the coarsest level stored in "
+		                          "the project file that is at least as fine as this resolution (in world units per voxel).");
+
 class RayView :
 		public sg::Agent<
 			RayView,
@@ -88,10 +94,14 @@ int main(int argc, char** argv) {
 		util::ProgramOptions::init(argc, argv);
 		logger::LogManager::init();
 
-		// create hdf5 stores
+		// create read-only hdf5 stores, such that other tools can use the 
+		// project at the same time
+
+		Hdf5TubeStore   tubeStore(optionProjectFile.as<std::string>(), true);
+		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>(), true);
 
-		Hdf5TubeStore   tubeStore(optionProjectFile.as<std::string>());
-		Hdf5VolumeStore volumeStore(optionProjectFile.as<std::string>());
+		// keep toggled tubes in memory, such that they are not read again
+		CachingTubeStore cachingStore(&tubeStore);
 
 		// get requested tube ids
 
@@ -117,19 +127,45 @@ int main(int argc, char** argv) {
 			}
 		}
 
-		// get intensities and labels
+		// get intensities and labels, only around the requested tubes if not 
+		// all of them are shown
 
 		auto intensities = std::make_shared<ExplicitVolume<float>>();
-		volumeStore.retrieveIntensities(*intensities);
 		ExplicitVolume<int> l;
-		volumeStore.retrieveLabels(l);
+
+		if (optionTubeId && optionTubeId.as<std::string>() != "all") {
+
+			Volumes volumes;
+			tubeStore.retrieveVolumes(ids, volumes, true);
+
+			util::box<float,3> boundingBox;
+			for (auto& p : volumes)
+				boundingBox += p.second.getBoundingBox();
+
+			volumeStore.retrieveIntensities(boundingBox, *intensities);
+			volumeStore.retrieveLabels(boundingBox, l);
+
+		} else if (optionVolumeResolution) {
+
+			float resolution = optionVolumeResolution;
+			int   level      = volumeStore.getLevel(util::point<float,3>(resolution, resolution, resolution));
+
+			volumeStore.retrieveIntensities(level, *intensities);
+			volumeStore.retrieveLabels(level, l);
+
+		} else {
+
+			volumeStore.retrieveIntensities(*intensities);
+			volumeStore.retrieveLabels(l);
+		}
+
 		auto labels = std::make_shared<ExplicitVolume<float>>(l);
 
 		// visualize
 
 		auto tubeView           = std::make_shared<TubeView>();
-		auto meshController     = std::make_shared<MeshViewController>(&tubeStore, labels);
-		auto skeletonController = std::make_shared<SkeletonViewController>(&tubeStore, labels);
+		auto meshController     = std::make_shared<MeshViewController>(&cachingStore, labels);
+		auto skeletonController = std::make_shared<SkeletonViewController>(&cachingStore, labels);
 		auto rotateView   = std::make_shared<RotateView>();
 		auto zoomView     = std::make_shared<ZoomView>(true);
 		auto window       = std::make_shared<sg_gui::Window>("tube viewer");
@@ -20,7 +20,7 @@ public:
 	 * symmetric link arcs, i.e., whenever node A links to node B with cost c, 
 	 * node B does also link to node A with the same costs c.
 	 */
-	bool isUndirected() { return _isUndirected; }
+	bool isUndirected() const { return _isUndirected; }
 
 	/**
 	 * Mark this graph as undirected. This does not change the graph and does 
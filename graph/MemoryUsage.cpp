@@ -0,0 +1,105 @@
+#include <iomanip>
+#include <algorithm>
+#include <sys/resource.h>
+#include "MemoryUsage.h"
+
+namespace host {
+
+namespace {
+
+// sizes of the node and arc records of lemon::ListDigraph
+const std::size_t ListDigraphNodeSize = 4*sizeof(int);
+const std::size_t ListDigraphArcSize  = 6*sizeof(int);
+
+// the capacity of std::string that is stored without a heap allocation
+const std::size_t SmallStringCapacity = std::string().capacity();
+
+std::size_t numArcSlots(const Graph& graph) {
+
+	return graph.maxArcId() + 1;
+}
+
+} // anonymous namespace
+
+std::size_t
+MemoryUsage::total() const {
+
+	std::size_t total = 0;
+	for (const auto& component : _components)
+		total += component.second;
+
+	return total;
+}
+
+std::size_t
+MemoryUsage::peakResidentSetSize() {
+
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+
+	// ru_maxrss is given in kilobytes on linux
+	return static_cast<std::size_t>(usage.ru_maxrss)*1024;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const MemoryUsage& usage) {
+
+	std::size_t width = 0;
+	for (const auto& component : usage)
+		width = std::max(width, component.first.size());
+
+	for (const auto& component : usage)
+		os
+				<< "  " << std::left << std::setw(width) << component.first << "  "
+				<< std::right << std::setw(12) << component.second << " bytes ("
+				<< (component.second/(1024*1024)) << " MB)" << std::endl;
+
+	os
+			<< "  " << std::left << std::setw(width) << "total" << "  "
+			<< std::right << std::setw(12) << usage.total() << " bytes ("
+			<< (usage.total()/(1024*1024)) << " MB)" << std::endl;
+
+	return os;
+}
+
+std::size_t
+memoryUsage(const Graph& graph) {
+
+	return
+			(graph.maxNodeId() + 1)*ListDigraphNodeSize +
+			(graph.maxArcId()  + 1)*ListDigraphArcSize;
+}
+
+std::size_t
+memoryUsage(const Graph& graph, const ArcWeights&) {
+
+	return numArcSlots(graph)*sizeof(double);
+}
+
+std::size_t
+memoryUsage(const Graph& graph, const ArcTypes&) {
+
+	return numArcSlots(graph)*sizeof(ArcType);
+}
+
+std::size_t
+memoryUsage(const Graph& graph, const ArcSelection&) {
+
+	// stored in a std::vector<bool>
+	return (numArcSlots(graph) + 7)/8;
+}
+
+std::size_t
+memoryUsage(const Graph& graph, const ArcLabels& labels) {
+
+	std::size_t bytes = numArcSlots(graph)*sizeof(std::string);
+
+	for (ArcIt arc(graph); arc != lemon::INVALID; ++arc)
+		if (labels[arc].capacity() > SmallStringCapacity)
+			bytes += labels[arc].capacity() + 1;
+
+	return bytes;
+}
+
+} // namespace host
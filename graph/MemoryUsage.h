@@ -0,0 +1,69 @@
+#ifndef HOST_GRAPH_MEMORY_USAGE_H__
+#define HOST_GRAPH_MEMORY_USAGE_H__
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "Graph.h"
+
+namespace host {
+
+/**
+ * A breakdown of memory usage in bytes by named components.
+ */
+class MemoryUsage {
+
+public:
+
+	typedef std::vector<std::pair<std::string, std::size_t>> Components;
+	typedef Components::const_iterator                       const_iterator;
+
+	/**
+	 * Add the bytes used by a component.
+	 */
+	void add(const std::string& component, std::size_t bytes) { _components.push_back(std::make_pair(component, bytes)); }
+
+	/**
+	 * The sum of all components.
+	 */
+	std::size_t total() const;
+
+	const_iterator begin() const { return _components.begin(); }
+	const_iterator end()   const { return _components.end(); }
+
+	/**
+	 * The peak resident set size of this process in bytes.
+	 */
+	static std::size_t peakResidentSetSize();
+
+private:
+
+	Components _components;
+};
+
+std::ostream& operator<<(std::ostream& os, const MemoryUsage& usage);
+
+/**
+ * Bytes used by the nodes and arcs of the given graph, without any maps.
+ */
+std::size_t memoryUsage(const Graph& graph);
+
+/**
+ * Bytes used by arc maps of the given graph.
+ */
+std::size_t memoryUsage(const Graph& graph, const ArcWeights& weights);
+std::size_t memoryUsage(const Graph& graph, const ArcTypes& types);
+std::size_t memoryUsage(const Graph& graph, const ArcSelection& selection);
+std::size_t memoryUsage(const Graph& graph, const ArcLabels& labels);
+
+/**
+ * Bytes allocated on the heap by arcs and edges (not including their own
+ * size).
+ */
+inline std::size_t heapMemoryUsage(const Arc&) { return 0; }
+inline std::size_t heapMemoryUsage(const Edge& edge) { return edge.size()*sizeof(Arc); }
+
+} // namespace host
+
+#endif // HOST_GRAPH_MEMORY_USAGE_H__
+
@@ -168,6 +168,22 @@ CandidateConflictTerm::gradient(
 	return feasible;
 }
 
+std::size_t
+CandidateConflictTerm::memoryUsage() const {
+
+	std::size_t bytes = sizeof(*this);
+
+	bytes += _exclusiveEdges.capacity()*sizeof(ExclusiveEdgesTerm);
+	bytes += _exclusiveArcs.capacity()*sizeof(ExclusiveArcsTerm);
+
+	for (const auto& exclusive : _exclusiveEdges)
+		bytes += exclusive.heapMemoryUsage();
+	for (const auto& exclusive : _exclusiveArcs)
+		bytes += exclusive.heapMemoryUsage();
+
+	return bytes;
+}
+
 void
 CandidateConflictTerm::findExclusiveEdges(const ArcTypes& arcTypes) {
 
@@ -1,11 +1,14 @@
 #ifndef HOST_CANDIDATE_CONFLICT_TERM_H__
 #define HOST_CANDIDATE_CONFLICT_TERM_H__
 
+#include <util/Logger.h>
 #include <graph/Graph.h>
 #include "HigherOrderArcTerm.h"
 #include "ExclusiveEdgesTerm.h"
 #include "ExclusiveArcsTerm.h"
 
+extern logger::LogChannel cctlog;
+
 namespace host {
 
 class CandidateConflictTerm : public HigherOrderArcTerm {
@@ -59,6 +62,11 @@ public:
 			Lambdas::iterator   begin,
 			Lambdas::iterator   end);
 
+	/**
+	 * Get the number of bytes used by this term.
+	 */
+	std::size_t memoryUsage() const;
+
 private:
 
 	typedef std::vector<Edge> Edges;
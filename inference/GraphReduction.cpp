@@ -0,0 +1,358 @@
+#include <map>
+#include <util/Logger.h>
+#include "GraphReduction.h"
+
+logger::LogChannel graphreductionlog("graphreductionlog", "[GraphReduction] ");
+
+namespace host {
+
+GraphReduction::GraphReduction(
+		const Graph&      graph,
+		const ArcWeights& weights,
+		const ArcLabels&  labels,
+		const ArcTypes&   types) :
+	_graph(graph),
+	_weights(weights),
+	_labels(labels),
+	_types(types),
+	_protected(graph, false),
+	_removedArcs(graph, false),
+	_forced(graph, false),
+	_removedNodes(graph, false),
+	_representatives(graph),
+	_outArcs(graph),
+	_reducedArcs(graph, lemon::INVALID),
+	_offset(0) {
+
+	for (NodeIt node(_graph); node != lemon::INVALID; ++node) {
+
+		_representatives[node] = node;
+
+		for (OutArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+			_outArcs[node].push_back(arc);
+	}
+}
+
+void
+GraphReduction::protect(const MultiEdgeFactors& factors) {
+
+	for (const auto& factor : factors)
+		for (const Edge& edge : factor.first)
+			for (const Arc& arc : edge)
+				protect(arc);
+}
+
+void
+GraphReduction::reduce(
+		Graph&      reduced,
+		ArcWeights& reducedWeights,
+		ArcLabels&  reducedLabels,
+		ArcTypes&   reducedTypes) {
+
+	_statistics = Statistics();
+	_statistics.numNodes = lemon::countNodes(_graph);
+	_statistics.numArcs  = lemon::countArcs(_graph);
+
+	removeUnreachable();
+
+	bool changed = true;
+	while (changed) {
+
+		changed  = contractForced();
+		changed |= removeDominated();
+	}
+
+	// create the reduced graph from the remaining nodes and arcs
+
+	reduced.clear();
+	reduced.setUndirected(_graph.isUndirected());
+
+	GraphBase::NodeMap<Node> reducedNodes(_graph, lemon::INVALID);
+
+	for (NodeIt node(_graph); node != lemon::INVALID; ++node)
+		if (!_removedNodes[node])
+			reducedNodes[node] = reduced.addNode();
+
+	reduced.setRoot(reducedNodes[_graph.getRoot()]);
+
+	for (ArcIt arc(_graph); arc != lemon::INVALID; ++arc) {
+
+		_reducedArcs[arc] = lemon::INVALID;
+
+		if (_removedArcs[arc])
+			continue;
+
+		Arc reducedArc = reduced.addArc(
+				reducedNodes[effectiveSource(arc)],
+				reducedNodes[_graph.target(arc)]);
+
+		reducedWeights[reducedArc] = _weights[arc];
+		reducedLabels[reducedArc]  = _labels[arc];
+		reducedTypes[reducedArc]   = _types[arc];
+
+		_reducedArcs[arc] = reducedArc;
+	}
+
+	_statistics.numReducedNodes = lemon::countNodes(reduced);
+	_statistics.numReducedArcs  = lemon::countArcs(reduced);
+
+	LOG_DEBUG(graphreductionlog) << _statistics << std::endl;
+}
+
+void
+GraphReduction::reduceFactors(
+		const MultiEdgeFactors& factors,
+		MultiEdgeFactors&       reducedFactors) const {
+
+	for (const auto& factor : factors) {
+
+		MultiEdgeFactors::Edges edges;
+		bool                    complete = true;
+
+		for (const Edge& edge : factor.first) {
+
+			Edge reducedEdge;
+			for (const Arc& arc : edge)
+				if (_reducedArcs[arc] != lemon::INVALID)
+					reducedEdge.addArc(_reducedArcs[arc]);
+
+			if (reducedEdge.size() == 0) {
+
+				complete = false;
+				break;
+			}
+
+			edges.push_back(reducedEdge);
+		}
+
+		// protected arcs are only removed if they are unreachable, in which
+		// case the factor can never be active
+		if (complete)
+			reducedFactors[edges] = factor.second;
+	}
+}
+
+void
+GraphReduction::expand(
+		const ArcSelection& reducedSelection,
+		ArcSelection&       selection) const {
+
+	for (ArcIt arc(_graph); arc != lemon::INVALID; ++arc)
+		selection[arc] =
+				_forced[arc] ||
+				(_reducedArcs[arc] != lemon::INVALID && reducedSelection[_reducedArcs[arc]]);
+}
+
+void
+GraphReduction::removeUnreachable() {
+
+	GraphBase::NodeMap<bool> reached(_graph, false);
+	std::vector<Node>        queue;
+
+	queue.push_back(_graph.getRoot());
+	reached[_graph.getRoot()] = true;
+
+	while (!queue.empty()) {
+
+		Node node = queue.back();
+		queue.pop_back();
+
+		for (OutArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+			if (!reached[_graph.target(arc)]) {
+
+				reached[_graph.target(arc)] = true;
+				queue.push_back(_graph.target(arc));
+			}
+	}
+
+	for (NodeIt node(_graph); node != lemon::INVALID; ++node) {
+
+		if (reached[node])
+			continue;
+
+		_removedNodes[node] = true;
+		_statistics.numUnreachableNodes++;
+
+		for (OutArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+			removeArc(arc);
+		for (InArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+			removeArc(arc);
+	}
+}
+
+bool
+GraphReduction::removeDominated() {
+
+	bool removed = false;
+
+	for (NodeIt target(_graph); target != lemon::INVALID; ++target) {
+
+		if (_removedNodes[target] || hasConflicts(target))
+			continue;
+
+		// the cheapest link arc from each source seen so far
+		std::map<Node, Arc> cheapest;
+
+		for (InArcIt arc(_graph, target); arc != lemon::INVALID; ++arc) {
+
+			if (_removedArcs[arc] || _protected[arc] || _types[arc] != Link)
+				continue;
+
+			Node source = effectiveSource(arc);
+
+			if (hasConflicts(source))
+				continue;
+
+			auto i = cheapest.find(source);
+
+			if (i == cheapest.end()) {
+
+				cheapest[source] = arc;
+				continue;
+			}
+
+			if (_weights[arc] < _weights[i->second]) {
+
+				removeArc(i->second);
+				i->second = arc;
+
+			} else {
+
+				removeArc(arc);
+			}
+
+			_statistics.numDominatedArcs++;
+			removed = true;
+		}
+	}
+
+	return removed;
+}
+
+bool
+GraphReduction::contractForced() {
+
+	bool contracted = false;
+
+	for (NodeIt node(_graph); node != lemon::INVALID; ++node) {
+
+		if (_removedNodes[node] || node == _graph.getRoot())
+			continue;
+
+		// find the only remaining incoming arc
+		Arc          forced = lemon::INVALID;
+		unsigned int numIn  = 0;
+		for (InArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+			if (!_removedArcs[arc]) {
+
+				forced = arc;
+				numIn++;
+			}
+
+		if (numIn != 1 || _protected[forced] || _types[forced] != Link)
+			continue;
+
+		Node parent = effectiveSource(forced);
+
+		// the terms on the conflicting nodes depend on their neighborhood,
+		// which we would change by moving arcs from node to parent
+		if (hasConflicts(node) || hasConflicts(parent))
+			continue;
+
+		bool contractible = true;
+		for (const Arc& arc : _outArcs[node]) {
+
+			if (_removedArcs[arc])
+				continue;
+
+			if (_protected[arc] || (_graph.target(arc) != parent && hasConflicts(_graph.target(arc)))) {
+
+				contractible = false;
+				break;
+			}
+		}
+
+		if (!contractible)
+			continue;
+
+		_forced[forced] = true;
+		_offset += _weights[forced];
+		removeArc(forced);
+
+		// arcs back to the parent would be self-loops, all others leave from
+		// the parent from now on
+		for (const Arc& arc : _outArcs[node]) {
+
+			if (_removedArcs[arc])
+				continue;
+
+			if (_graph.target(arc) == parent)
+				removeArc(arc);
+			else
+				_outArcs[parent].push_back(arc);
+		}
+
+		_outArcs[node].clear();
+		_representatives[node] = parent;
+		_removedNodes[node]    = true;
+
+		_statistics.numForcedArcs++;
+		contracted = true;
+	}
+
+	return contracted;
+}
+
+Node
+GraphReduction::representative(Node node) {
+
+	Node root = node;
+	while (_representatives[root] != root)
+		root = _representatives[root];
+
+	// compress the path
+	while (node != root) {
+
+		Node next = _representatives[node];
+		_representatives[node] = root;
+		node = next;
+	}
+
+	return root;
+}
+
+bool
+GraphReduction::hasConflicts(const Node& node) const {
+
+	for (OutArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+		if (!_removedArcs[arc] && _types[arc] == Conflict)
+			return true;
+
+	for (InArcIt arc(_graph, node); arc != lemon::INVALID; ++arc)
+		if (!_removedArcs[arc] && _types[arc] == Conflict)
+			return true;
+
+	return false;
+}
+
+void
+GraphReduction::removeArc(const Arc& arc) {
+
+	_removedArcs[arc] = true;
+}
+
+std::ostream&
+operator<<(std::ostream& os, const GraphReduction::Statistics& statistics) {
+
+	os
+			<< "reduced graph from "
+			<< statistics.numNodes << " nodes and " << statistics.numArcs << " arcs to "
+			<< statistics.numReducedNodes << " nodes and " << statistics.numReducedArcs << " arcs ("
+			<< statistics.numUnreachableNodes << " unreachable nodes, "
+			<< statistics.numDominatedArcs << " dominated arcs, "
+			<< statistics.numForcedArcs << " contracted arcs)";
+
+	return os;
+}
+
+} // namespace host
@@ -0,0 +1,168 @@
+#ifndef HOST_INFERENCE_GRAPH_REDUCTION_H__
+#define HOST_INFERENCE_GRAPH_REDUCTION_H__
+
+#include <vector>
+#include <ostream>
+#include <graph/Graph.h>
+#include "MultiEdgeFactors.h"
+
+namespace host {
+
+/**
+ * Reduces a graph before the search for the HOST by removing arcs that can
+ * not be part of an optimal arborescence, and by contracting arcs that have to
+ * be part of every arborescence. The following reductions are applied until
+ * none of them changes the graph anymore:
+ *
+ *   unreachable nodes
+ *
+ *     nodes that can not be reached from the root are removed with all their
+ *     arcs
+ *
+ *   dominated arcs
+ *
+ *     of parallel link arcs between the same two nodes, only the one with the
+ *     smallest weight is kept
+ *
+ *   forced arcs
+ *
+ *     if the only arc into a node v is a link arc (u,v), it is part of every
+ *     arborescence; v is merged into u, and the remaining arcs of v leave
+ *     from u instead
+ *
+ * Arcs and nodes that are involved in conflicts or factors are left as they
+ * are (see protect()), such that the terms on the reduced graph are
+ * equivalent to the terms on the original graph.
+ */
+class GraphReduction {
+
+public:
+
+	/**
+	 * Statistics about the last call to reduce().
+	 */
+	struct Statistics {
+
+		Statistics() :
+			numNodes(0),
+			numArcs(0),
+			numReducedNodes(0),
+			numReducedArcs(0),
+			numUnreachableNodes(0),
+			numDominatedArcs(0),
+			numForcedArcs(0) {}
+
+		std::size_t numNodes;
+		std::size_t numArcs;
+		std::size_t numReducedNodes;
+		std::size_t numReducedArcs;
+
+		std::size_t numUnreachableNodes;
+		std::size_t numDominatedArcs;
+		std::size_t numForcedArcs;
+	};
+
+	GraphReduction(
+			const Graph&      graph,
+			const ArcWeights& weights,
+			const ArcLabels&  labels,
+			const ArcTypes&   types);
+
+	/**
+	 * Prevent the given arc from being removed or contracted.
+	 */
+	void protect(const Arc& arc) { _protected[arc] = true; }
+
+	/**
+	 * Protect all arcs that are part of the given factors.
+	 */
+	void protect(const MultiEdgeFactors& factors);
+
+	/**
+	 * Reduce the graph given in the constructor and store the result in
+	 * reduced. The arc maps have to belong to the reduced graph.
+	 */
+	void reduce(
+			Graph&      reduced,
+			ArcWeights& reducedWeights,
+			ArcLabels&  reducedLabels,
+			ArcTypes&   reducedTypes);
+
+	/**
+	 * Transfer factors on the original graph to the reduced graph. Factors
+	 * that involve removed arcs are dropped, since their edges can never be
+	 * selected.
+	 */
+	void reduceFactors(
+			const MultiEdgeFactors& factors,
+			MultiEdgeFactors&       reducedFactors) const;
+
+	/**
+	 * Expand a selection of arcs on the reduced graph to a selection on the
+	 * original graph. Contracted arcs are always selected.
+	 */
+	void expand(
+			const ArcSelection& reducedSelection,
+			ArcSelection&       selection) const;
+
+	/**
+	 * The summed weight of all contracted arcs. Add this to the value of a
+	 * solution on the reduced graph to get the value on the original graph.
+	 */
+	double getOffset() const { return _offset; }
+
+	const Statistics& getStatistics() const { return _statistics; }
+
+private:
+
+	// remove all nodes that can not be reached from the root
+	void removeUnreachable();
+
+	// remove dominated parallel arcs, returns true if any arc was removed
+	bool removeDominated();
+
+	// contract forced arcs, returns true if any arc was contracted
+	bool contractForced();
+
+	// the node that the given node was merged into
+	Node representative(Node node);
+
+	// the source of an arc after contractions
+	Node effectiveSource(const Arc& arc) { return representative(_graph.source(arc)); }
+
+	// true, if the node has any conflict arc that was not removed
+	bool hasConflicts(const Node& node) const;
+
+	void removeArc(const Arc& arc);
+
+	const Graph&      _graph;
+	const ArcWeights& _weights;
+	const ArcLabels&  _labels;
+	const ArcTypes&   _types;
+
+	GraphBase::ArcMap<bool>  _protected;
+	GraphBase::ArcMap<bool>  _removedArcs;
+	GraphBase::ArcMap<bool>  _forced;
+	GraphBase::NodeMap<bool> _removedNodes;
+
+	// the node each node was merged into, the node itself if not merged
+	GraphBase::NodeMap<Node> _representatives;
+
+	// the remaining outgoing arcs of each node, including the arcs of nodes
+	// that were merged into it
+	GraphBase::NodeMap<std::vector<Arc>> _outArcs;
+
+	// the arc in the reduced graph for each arc in the original graph
+	GraphBase::ArcMap<Arc> _reducedArcs;
+
+	double _offset;
+
+	Statistics _statistics;
+};
+
+std::ostream& operator<<(std::ostream& os, const GraphReduction::Statistics& statistics);
+
+} // namespace host
+
+#endif // HOST_INFERENCE_GRAPH_REDUCTION_H__
+
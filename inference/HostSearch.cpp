@@ -16,6 +16,13 @@ HostSearch::addTerm(ArcTerm* term) {
 		_higherOrderArcTerms.push_back(higherOrderTerm);
 }
 
+void
+HostSearch::clearTerms() {
+
+	_arcTerms.clear();
+	_higherOrderArcTerms.clear();
+}
+
 bool
 HostSearch::find(
 		host::ArcSelection& mst,
@@ -23,6 +30,8 @@ HostSearch::find(
 		unsigned int        maxIterations,
 		const Lambdas&      initialLambdas) {
 
+	_startTime = std::chrono::steady_clock::now();
+
 	ValueGradientCallback valueGradientCallback(*this, mst);
 
 	Optimizer optimizer(
@@ -51,6 +60,8 @@ HostSearch::find(
 
 	optimizer.optimize();
 
+	_bundleMemoryUsage = optimizer.memoryUsage();
+
 	LOG_ALL(hostsearchlog)
 			<< "final weights are:" << _graph << std::endl;
 	for (host::Graph::ArcIt arc(_graph); arc != lemon::INVALID; ++arc)
@@ -101,9 +112,33 @@ HostSearch::ValueGradientCallback::operator()(
 	if (feasible)
 		LOG_USER(hostsearchlog) << "Feasible solution found." << std::endl;
 
+	if (_hostSearch.timeLimitExceeded()) {
+
+		LOG_DEBUG(hostsearchlog) << "time limit exceeded, stopping search" << std::endl;
+		return Optimizer::Stop;
+	}
+
 	return Optimizer::Continue;
 }
 
+bool
+HostSearch::timeLimitExceeded() const {
+
+	if (_timeLimit <= 0)
+		return false;
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _startTime;
+
+	return elapsed.count() > _timeLimit;
+}
+
+void
+HostSearch::memoryUsage(MemoryUsage& usage) const {
+
+	usage.add("search weights", host::memoryUsage(_graph, _currentWeights));
+	usage.add("bundle", _bundleMemoryUsage);
+}
+
 size_t
 HostSearch::numLambdas() {
 
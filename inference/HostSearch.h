@@ -2,10 +2,14 @@
 #define HOST_INFERENCE_HOST_SEARCH_H__
 
 #include <vector>
+#include <chrono>
+#include <graph/MemoryUsage.h>
 #include "ArcTerm.h"
 #include "HigherOrderArcTerm.h"
 #include "ProximalBundleMethod.h"
 
+extern logger::LogChannel hostsearchlog;
+
 namespace host {
 
 class HostSearch {
@@ -14,13 +18,35 @@ public:
 
 	HostSearch(const host::Graph& graph) :
 		_currentWeights(graph),
-		_graph(graph) {}
+		_graph(graph),
+		_timeLimit(0),
+		_bundleMemoryUsage(0) {}
 
 	/**
 	 * Add an arc term to the objective of this search.
 	 */
 	void addTerm(ArcTerm* term);
 
+	/**
+	 * Remove all terms from the objective of this search. Use this to reuse 
+	 * the search (and its memory) for another problem on the same graph 
+	 * object.
+	 */
+	void clearTerms();
+
+	/**
+	 * Limit the time (in seconds) that find() spends on the search. The search 
+	 * stops after the first iteration that exceeds the limit. Set to 0 to 
+	 * disable the limit (the default).
+	 */
+	void setTimeLimit(double seconds) { _timeLimit = seconds; }
+
+	/**
+	 * Add the memory used by this search (the current weights and the bundle 
+	 * of the last call to find()) to the given memory usage report.
+	 */
+	void memoryUsage(MemoryUsage& usage) const;
+
 	/**
 	 * Find a minimal spanning tree on a consistent subset of the provided 
 	 * candidate nodes.
@@ -75,6 +101,9 @@ private:
 
 	size_t numLambdas();
 
+	// true, if a time limit was set and find() is running longer than that
+	bool timeLimitExceeded() const;
+
 	// set the lambdas in all higher-order arc terms
 	void setLambdas(const Lambdas& x);
 
@@ -104,6 +133,15 @@ private:
 	const host::Graph& _graph;
 
 	bool _feasibleSolutionFound;
+
+	// time limit in seconds, 0 for none
+	double _timeLimit;
+
+	// the time find() was called
+	std::chrono::steady_clock::time_point _startTime;
+
+	// the memory used by the optimizer in the last call to find()
+	std::size_t _bundleMemoryUsage;
 };
 
 } // namespace host
@@ -0,0 +1,51 @@
+#include <algorithm>
+#include "MemoryEstimate.h"
+#include "ExclusiveEdgesTerm.h"
+#include "ExclusiveArcsTerm.h"
+#include "MultiEdgeFactors.h"
+
+namespace host {
+
+MemoryUsage
+estimateMemoryUsage(const ProblemSize& size) {
+
+	MemoryUsage usage;
+
+	const std::size_t numArcs  = size.numLinkArcs + size.numConflictArcs;
+	const double      numNodes = std::max(std::size_t(1), size.numNodes);
+
+	// the graph itself, same record sizes as in memoryUsage(const Graph&)
+	usage.add("graph", size.numNodes*4*sizeof(int) + numArcs*6*sizeof(int));
+
+	// weights, labels, types, and the MST of host, the current weights of 
+	// HostSearch
+	usage.add("arc maps",
+			numArcs*(2*sizeof(double) + sizeof(std::string) + sizeof(ArcType)) +
+			(numArcs + 7)/8);
+
+	// each conflict between two nodes creates one exclusive edge term for each 
+	// pair of link edges of the two nodes
+	const double linkDegree     = std::max(1.0, size.numLinkArcs/numNodes);
+	const double conflictDegree = size.numConflictArcs/numNodes;
+
+	const std::size_t numExclusiveEdges = static_cast<std::size_t>((size.numConflictArcs/2)*linkDegree*linkDegree);
+	const std::size_t numExclusiveArcs  = static_cast<std::size_t>(size.numConflictArcs*conflictDegree);
+
+	usage.add("conflict term",
+			numExclusiveEdges*(sizeof(ExclusiveEdgesTerm) + 4*sizeof(double) + 4*sizeof(Arc)) +
+			numExclusiveArcs*(sizeof(ExclusiveArcsTerm) + 4*sizeof(double)));
+
+	// each factor is stored in three maps, see MultiFactorTermImpl
+	usage.add("multi-edge factor term",
+			3*(size.numFactors*(4*sizeof(void*) + sizeof(MultiEdgeFactors::Edges) + 2*sizeof(double)) +
+			   size.numFactorEdges*(sizeof(Edge) + 2*sizeof(Arc))));
+
+	// the bundle method stores one dense row per iteration
+	const std::size_t numLambdas = 4*(numExclusiveEdges + numExclusiveArcs) + 2*size.numFactors;
+
+	usage.add("bundle", (size.numIterations + 1)*(numLambdas*sizeof(double) + sizeof(std::vector<double>)) + 9*numLambdas*sizeof(double));
+
+	return usage;
+}
+
+} // namespace host
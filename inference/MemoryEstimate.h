@@ -0,0 +1,48 @@
+#ifndef HOST_INFERENCE_MEMORY_ESTIMATE_H__
+#define HOST_INFERENCE_MEMORY_ESTIMATE_H__
+
+#include <graph/MemoryUsage.h>
+
+namespace host {
+
+/**
+ * The size of a problem, as far as it is relevant for the memory consumption 
+ * of HostSearch and its terms.
+ */
+struct ProblemSize {
+
+	ProblemSize() :
+		numNodes(0),
+		numLinkArcs(0),
+		numConflictArcs(0),
+		numFactors(0),
+		numFactorEdges(0),
+		numIterations(0) {}
+
+	// the number of nodes in the graph
+	std::size_t numNodes;
+
+	// the number of link and conflict arcs, after opposite arcs have been 
+	// added
+	std::size_t numLinkArcs;
+	std::size_t numConflictArcs;
+
+	// the number of multi-edge factors and the total number of edges in them
+	std::size_t numFactors;
+	std::size_t numFactorEdges;
+
+	// the maximal number of iterations of the bundle method
+	std::size_t numIterations;
+};
+
+/**
+ * Estimate the memory needed to solve a problem of the given size, before any 
+ * of it is allocated. The estimate assumes that link and conflict arcs are 
+ * evenly distributed over the nodes.
+ */
+MemoryUsage estimateMemoryUsage(const ProblemSize& size);
+
+} // namespace host
+
+#endif // HOST_INFERENCE_MEMORY_ESTIMATE_H__
+
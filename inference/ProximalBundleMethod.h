@@ -160,6 +160,12 @@ public:
 	 */
 	Status getStatus() const { return _status; }
 
+	/**
+	 * Get the number of bytes used by the bundle and the vectors of this 
+	 * method.
+	 */
+	std::size_t memoryUsage() const;
+
 private:
 
 	/**
@@ -510,6 +516,37 @@ ProximalBundleMethod<ValueGradientCallback>:: getOptimalGradient() const {
 	return _optimalGradient;
 }
 
+template <typename ValueGradientCallback>
+std::size_t
+ProximalBundleMethod<ValueGradientCallback>::memoryUsage() const {
+
+	std::size_t bytes = sizeof(*this);
+
+	// the dense rows of the bundle
+	bytes += _A.capacity()*sizeof(typename rows_type::value_type);
+	for (const auto& row : _A)
+		bytes += row.capacity()*sizeof(double);
+
+	bytes += _b.capacity()*sizeof(double);
+
+	const std::vector<double>* vectors[] = {
+			&_initialPosition,
+			&_proxCenter_t,
+			&_previous_proxCenter_t,
+			&_previous_gradient,
+			&_lambda_tp1,
+			&_lambda_t,
+			&_gradient_tp1,
+			&_optimalPosition,
+			&_optimalGradient
+	};
+
+	for (const std::vector<double>* v : vectors)
+		bytes += v->capacity()*sizeof(double);
+
+	return bytes;
+}
+
 template <typename ValueGradientCallback>
 void
 ProximalBundleMethod<ValueGradientCallback>::setObjective() {
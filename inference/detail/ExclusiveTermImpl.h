@@ -4,6 +4,7 @@
 #include <ostream>
 #include <util/helpers.hpp>
 #include <graph/Logging.h>
+#include <graph/MemoryUsage.h>
 #include <inference/HigherOrderArcTerm.h>
 #include <inference/Configuration.h>
 
@@ -161,6 +162,17 @@ public:
 
 	const Lambdas& lambdas() const { return _lambdas; }
 
+	/**
+	 * Get the number of bytes this term allocated on the heap.
+	 */
+	std::size_t heapMemoryUsage() const {
+
+		return
+				_lambdas.capacity()*sizeof(double) +
+				host::heapMemoryUsage(_edge1) +
+				host::heapMemoryUsage(_edge2);
+	}
+
 	bool operator==(const ExclusiveTermImpl<EdgeType>& other) const {
 
 		return ((_edge1 == other._edge1) && (_edge2 == other._edge2)) ||
@@ -5,6 +5,7 @@
 #include <inference/HigherOrderArcTerm.h>
 #include <inference/Configuration.h>
 #include <graph/Logging.h>
+#include <graph/MemoryUsage.h>
 #include <util/Logger.h>
 #include <util/exceptions.h>
 #include "MultiFactorsImpl.h"
@@ -69,6 +70,11 @@ public:
 			Lambdas::iterator         begin,
 			Lambdas::iterator         end);
 
+	/**
+	 * Get the number of bytes used by this term.
+	 */
+	std::size_t memoryUsage() const;
+
 private:
 
 	typedef typename MultiFactorsImpl<EdgeType>::Edges EdgesType;
@@ -236,6 +242,31 @@ MultiFactorTermImpl<EdgeType>::gradient(
 	return feasible;
 }
 
+template <typename EdgeType>
+std::size_t
+MultiFactorTermImpl<EdgeType>::memoryUsage() const {
+
+	// approximate size of the bookkeeping of a node in a std::map
+	const std::size_t mapNodeSize = 4*sizeof(void*);
+
+	std::size_t bytes = sizeof(*this);
+
+	for (const auto& factor : _factors) {
+
+		const EdgesType& edges = factor.first;
+
+		std::size_t keyBytes = sizeof(EdgesType) + edges.capacity()*sizeof(EdgeType);
+		for (const auto& edge : edges)
+			keyBytes += host::heapMemoryUsage(edge);
+
+		// each factor is a key in _factors, _lambdas, and _z
+		bytes += 3*(mapNodeSize + keyBytes);
+		bytes += sizeof(double) + sizeof(std::pair<double, double>) + sizeof(bool);
+	}
+
+	return bytes;
+}
+
 } // namespace detail
 } // namespace host
 
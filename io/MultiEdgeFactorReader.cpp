@@ -36,4 +36,31 @@ MultiEdgeFactorReader::fill(
 	}
 }
 
+void
+MultiEdgeFactorReader::count(
+		std::size_t& numFactors,
+		std::size_t& numFactorEdges) {
+
+	std::ifstream in(_filename);
+
+	numFactors     = 0;
+	numFactorEdges = 0;
+
+	std::string line;
+	while (std::getline(in, line)) {
+
+		std::stringstream ss(line);
+
+		double value;
+		if (!(ss >> value))
+			continue;
+
+		std::string label;
+		while (ss >> label)
+			numFactorEdges++;
+
+		numFactors++;
+	}
+}
+
 } // namespace host
@@ -18,6 +18,14 @@ public:
 			const ArcLabels&  labels,
 			MultiEdgeFactors& factors);
 
+	/**
+	 * Count the factors and the total number of edges in them without reading 
+	 * the graph.
+	 */
+	void count(
+			std::size_t& numFactors,
+			std::size_t& numFactorEdges);
+
 private:
 
 	std::string _filename;
@@ -1,3 +1,6 @@
+#include <fstream>
+#include <sstream>
+#include <vector>
 #include <lemon/lgf_reader.h>
 #include <util/exceptions.h>
 #include <graph/Logging.h>
@@ -61,6 +64,108 @@ WeightedGraphReader::fill(
 		addOppositeArc(graph, arc, weights, labels, types);
 }
 
+void
+WeightedGraphReader::count(
+		std::size_t& numNodes,
+		std::size_t& numLinkArcs,
+		std::size_t& numConflictArcs) {
+
+	std::ifstream is(_filename.c_str());
+
+	if (!is.good())
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not open " << _filename);
+
+	numNodes        = 0;
+	numLinkArcs     = 0;
+	numConflictArcs = 0;
+
+	bool isUndirected = true;
+
+	enum { None, Nodes, Arcs, Attributes } section = None;
+
+	// the header line of the current section has been read
+	bool header = false;
+
+	// the column of the arc type, after source and target
+	int typeColumn = -1;
+
+	std::string line;
+	while (std::getline(is, line)) {
+
+		std::stringstream ss(line);
+		std::string first;
+		if (!(ss >> first) || first[0] == '#')
+			continue;
+
+		if (first[0] == '@') {
+
+			if (first == "@nodes")
+				section = Nodes;
+			else if (first == "@arcs" || first == "@edges")
+				section = Arcs;
+			else if (first == "@attributes")
+				section = Attributes;
+			else
+				section = None;
+
+			header = false;
+			continue;
+		}
+
+		switch (section) {
+
+			case Nodes:
+
+				if (header)
+					numNodes++;
+				header = true;
+				break;
+
+			case Arcs:
+
+				{
+					std::vector<std::string> columns(1, first);
+					std::string column;
+					while (ss >> column)
+						columns.push_back(column);
+
+					if (!header) {
+
+						// the header has no columns for source and target
+						for (std::size_t i = 0; i < columns.size(); i++)
+							if (columns[i] == "type")
+								typeColumn = i + 2;
+
+						header = true;
+						break;
+					}
+
+					if (typeColumn >= 0 && typeColumn < static_cast<int>(columns.size()) && columns[typeColumn] == "1")
+						numConflictArcs++;
+					else
+						numLinkArcs++;
+				}
+				break;
+
+			case Attributes:
+
+				if (first == "undirected")
+					ss >> isUndirected;
+				break;
+
+			default:
+				break;
+		}
+	}
+
+	if (isUndirected)
+		numLinkArcs *= 2;
+
+	numConflictArcs *= 2;
+}
+
 void
 WeightedGraphReader::addOppositeArc(
 		host::Graph& graph,
@@ -20,6 +20,16 @@ public:
 			host::ArcLabels& labels,
 			host::ArcTypes& types);
 
+	/**
+	 * Count the nodes, link arcs, and conflict arcs of the graph without 
+	 * creating it. The arc counts include the opposite arcs that fill() would 
+	 * add.
+	 */
+	void count(
+			std::size_t& numNodes,
+			std::size_t& numLinkArcs,
+			std::size_t& numConflictArcs);
+
 private:
 
 	void addOppositeArc(
@@ -0,0 +1,142 @@
+#include <vector>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#ifdef HOST_WITH_ZSTD
+#include <boost/iostreams/filter/zstd.hpp>
+#endif
+#include <lemon/lgf_writer.h>
+#include <util/exceptions.h>
+#include "WeightedGraphWriter.h"
+
+namespace host {
+
+namespace {
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+template <typename T>
+void writeRaw(std::ostream& os, const T& value) {
+
+	os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+} // anonymous namespace
+
+void
+WeightedGraphWriter::write(const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection) {
+
+	std::string basename = _filename;
+	Compression c = compression(basename);
+
+	boost::iostreams::filtering_ostream os;
+
+	if (c == Gzip)
+		os.push(boost::iostreams::gzip_compressor(), _bufferSize);
+#ifdef HOST_WITH_ZSTD
+	if (c == Zstd)
+		os.push(boost::iostreams::zstd_compressor(), _bufferSize);
+#endif
+
+	boost::iostreams::file_sink file(_filename, std::ios_base::out | std::ios_base::binary);
+
+	if (!file.is_open())
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"can not open " << _filename << " for writing");
+
+	os.push(file, _bufferSize);
+
+	if (endsWith(basename, ".lgf"))
+		writeLgf(os, graph, weights, arcSelection);
+	else if (endsWith(basename, ".bin"))
+		writeBinary(os, graph, weights, arcSelection);
+	else
+		writeGuess(os, graph, weights, arcSelection);
+
+	// flushes the buffers and finishes the compression stream
+	os.reset();
+}
+
+WeightedGraphWriter::Compression
+WeightedGraphWriter::compression(std::string& basename) const {
+
+	if (endsWith(basename, ".gz")) {
+
+		basename.resize(basename.size() - 3);
+		return Gzip;
+	}
+
+	if (endsWith(basename, ".zst")) {
+
+#ifdef HOST_WITH_ZSTD
+		basename.resize(basename.size() - 4);
+		return Zstd;
+#else
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"zstd compression requested for " << _filename << ", but host was compiled without HOST_WITH_ZSTD");
+#endif
+	}
+
+	return NoCompression;
+}
+
+void
+WeightedGraphWriter::writeLgf(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection) {
+
+	lemon::digraphWriter(graph, os).arcMap("weight", weights).arcMap("mst", arcSelection).run();
+}
+
+void
+WeightedGraphWriter::writeGuess(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection) {
+
+	os << "nodedef>name VARCHAR\n";
+
+	for (host::Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
+		os << graph.id(node) << '\n';
+
+	os << "arcdef>node1 VARCHAR,node2 VARCHAR,weight DOUBLE,mst BOOLEAN\n";
+
+	for (host::Graph::ArcIt arc(graph); arc != lemon::INVALID; ++arc)
+		os
+				<< graph.id(graph.source(arc)) << ','
+				<< graph.id(graph.target(arc)) << ','
+				<< weights[arc] << ','
+				<< arcSelection[arc] << '\n';
+}
+
+void
+WeightedGraphWriter::writeBinary(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection) {
+
+	std::vector<host::Arc> selected;
+	for (host::Graph::ArcIt arc(graph); arc != lemon::INVALID; ++arc)
+		if (arcSelection[arc])
+			selected.push_back(arc);
+
+	unsigned int magic   = BinaryMagic;
+	unsigned int version = BinaryVersion;
+	int          root    = graph.id(graph.getRoot());
+	unsigned int numArcs = selected.size();
+
+	writeRaw(os, magic);
+	writeRaw(os, version);
+	writeRaw(os, root);
+	writeRaw(os, numArcs);
+
+	for (const host::Arc& arc : selected) {
+
+		int    source = graph.id(graph.source(arc));
+		int    target = graph.id(graph.target(arc));
+		double weight = weights[arc];
+
+		writeRaw(os, source);
+		writeRaw(os, target);
+		writeRaw(os, weight);
+	}
+}
+
+} // namespace host
@@ -1,16 +1,46 @@
 #ifndef HOST_GRAPHS_WEIGHTED_GRAPH_WRITER_H__
 #define HOST_GRAPHS_WEIGHTED_GRAPH_WRITER_H__
 
-#include <lemon/lgf_writer.h>
+#include <string>
+#include <ostream>
+#include <graph/Graph.h>
 
 namespace host {
 
+/**
+ * Writes a weighted graph together with a selection of arcs (usually the
+ * result of a HostSearch). The format is determined by the filename:
+ *
+ *   *.lgf
+ *
+ *     lemon graph format with arc maps "weight" and "mst"
+ *
+ *   *.bin
+ *
+ *     compact binary format that contains only the selected arcs (see
+ *     writeBinary())
+ *
+ *   anything else
+ *
+ *     GUESS format with all nodes and arcs
+ *
+ * An additional suffix ".gz" (or ".zst", if compiled with HOST_WITH_ZSTD)
+ * compresses the output on the fly, e.g., "result.bin.gz". All output is
+ * written through a large buffer, nothing gets flushed per line.
+ */
 class WeightedGraphWriter {
 
 public:
 
-	WeightedGraphWriter(const std::string& filename) :
-		_filename(filename) {}
+	/**
+	 * Magic number at the beginning of binary result files ("HARB").
+	 */
+	static const unsigned int BinaryMagic   = 0x42524148;
+	static const unsigned int BinaryVersion = 1;
+
+	WeightedGraphWriter(const std::string& filename, std::size_t bufferSize = 1 << 20) :
+		_filename(filename),
+		_bufferSize(bufferSize) {}
 
 	void write(const host::Graph& graph, const host::ArcWeights& weights) {
 
@@ -18,35 +48,41 @@ public:
 		write(graph, weights, dummy);
 	}
 
-	void write(const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection) {
-
-		std::ofstream os(_filename.c_str());
+	void write(const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection);
 
-		if (_filename.find(".lgf") != std::string::npos) {
+private:
 
-			lemon::digraphWriter(graph, os).arcMap("weight", weights).arcMap("mst", arcSelection).run();
+	enum Compression {
 
-		} else { // write in GUESS format
+		NoCompression,
+		Gzip,
+		Zstd
+	};
 
-			os << "nodedef>name VARCHAR" << std::endl;
+	// strip a compression suffix from the filename and return the compression
+	Compression compression(std::string& basename) const;
 
-			for (host::Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
-				os << graph.id(node) << std::endl;
+	void writeLgf(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection);
 
-			os << "arcdef>node1 VARCHAR,node2 VARCHAR,weight DOUBLE,mst BOOLEAN" << std::endl;
+	void writeGuess(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection);
 
-			for (host::Graph::ArcIt arc(graph); arc != lemon::INVALID; ++arc)
-				os
-						<< graph.id(graph.source(arc)) << ","
-						<< graph.id(graph.target(arc)) << ","
-						<< weights[arc] << ","
-						<< arcSelection[arc] << std::endl;
-		}
-	}
-
-private:
+	/**
+	 * Binary layout (native byte order):
+	 *
+	 *   uint32  magic
+	 *   uint32  version
+	 *   int32   root node id
+	 *   uint32  number of selected arcs n
+	 *   n times:
+	 *     int32   source node id
+	 *     int32   target node id
+	 *     double  weight
+	 */
+	void writeBinary(std::ostream& os, const host::Graph& graph, const host::ArcWeights& weights, const host::ArcSelection& arcSelection);
 
 	std::string _filename;
+
+	std::size_t _bufferSize;
 };
 
 } // namespace host
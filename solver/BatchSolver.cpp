@@ -0,0 +1,239 @@
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <inference/HostSearch.h>
+#include <inference/CandidateConflictTerm.h>
+#include <inference/MultiEdgeFactorTerm.h>
+#include "BatchSolver.h"
+
+logger::LogChannel batchsolverlog("batchsolverlog", "[BatchSolver] ");
+
+namespace host {
+
+BatchSolver::BatchSolver(unsigned int numThreads, unsigned int numIterations) :
+	_numThreads(numThreads),
+	_numIterations(numIterations),
+	_nextJob(0),
+	_numFailed(0) {
+
+	if (_numThreads == 0)
+		_numThreads = std::max(1u, std::thread::hardware_concurrency());
+}
+
+void
+BatchSolver::addJobs(
+		const std::string& manifestOrDirectory,
+		const std::string& resultDirectory,
+		const std::string& resultSuffix) {
+
+	if (!boost::filesystem::exists(manifestOrDirectory))
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				manifestOrDirectory << " does not exist");
+
+	if (!resultDirectory.empty())
+		boost::filesystem::create_directories(resultDirectory);
+
+	if (boost::filesystem::is_directory(manifestOrDirectory))
+		addJobsFromDirectory(manifestOrDirectory, resultDirectory, resultSuffix);
+	else
+		addJobsFromManifest(manifestOrDirectory, resultDirectory, resultSuffix);
+
+	LOG_USER(batchsolverlog) << "batch contains " << _jobs.size() << " jobs" << std::endl;
+}
+
+unsigned int
+BatchSolver::solve() {
+
+	_results.assign(_jobs.size(), HostSolver::Result());
+	_failed.assign(_jobs.size(), false);
+	_nextJob   = 0;
+	_numFailed = 0;
+
+	unsigned int numThreads = std::min<std::size_t>(_numThreads, _jobs.size());
+
+	LOG_USER(batchsolverlog) << "solving " << _jobs.size() << " jobs with " << numThreads << " threads" << std::endl;
+
+	// the log channels of the searches are not synchronized, while the 
+	// workers run they report errors only
+	std::vector<logger::LogChannel*> searchChannels = {
+			&hostsearchlog,
+			&cctlog,
+			&meflog,
+			&proxbundlemethodlog };
+
+	std::vector<logger::LogLevel> searchLevels;
+	for (logger::LogChannel* channel : searchChannels) {
+
+		searchLevels.push_back(channel->getLogLevel());
+		channel->setLogLevel(logger::Error);
+	}
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&BatchSolver::work, this));
+
+	for (auto& worker : workers)
+		worker.join();
+
+	for (std::size_t i = 0; i < searchChannels.size(); i++)
+		searchChannels[i]->setLogLevel(searchLevels[i]);
+
+	return _numFailed;
+}
+
+void
+BatchSolver::printSummary(std::ostream& os) const {
+
+	for (std::size_t i = 0; i < _results.size(); i++) {
+
+		os << _jobs[i].graphFile << "\t";
+
+		if (_failed[i])
+			os << "failed\n";
+		else
+			os
+					<< _results[i].length << "\t"
+					<< (_results[i].constraintsFulfilled ? "fulfilled" : "violated") << "\n";
+	}
+
+	os.flush();
+}
+
+void
+BatchSolver::work() {
+
+	// one solver per thread, reused for all jobs of this thread; only the 
+	// summary of each job is logged, under _outputMutex
+	HostSolver solver(_numIterations);
+
+	while (true) {
+
+		std::size_t i = _nextJob++;
+
+		if (i >= _jobs.size())
+			return;
+
+		try {
+
+			_results[i] = solver.solve(_jobs[i]);
+
+			std::lock_guard<std::mutex> lock(_outputMutex);
+			LOG_DEBUG(batchsolverlog)
+					<< "solved " << _jobs[i].graphFile
+					<< " (" << _results[i].numNodes << " nodes, "
+					<< _results[i].numArcs << " arcs), length "
+					<< _results[i].length << std::endl;
+
+		} catch (boost::exception& e) {
+
+			_failed[i] = true;
+			_numFailed++;
+
+			std::lock_guard<std::mutex> lock(_outputMutex);
+			LOG_ERROR(batchsolverlog) << "could not solve " << _jobs[i].graphFile << ":" << std::endl;
+			handleException(e, std::cerr);
+
+		} catch (std::exception& e) {
+
+			_failed[i] = true;
+			_numFailed++;
+
+			std::lock_guard<std::mutex> lock(_outputMutex);
+			LOG_ERROR(batchsolverlog) << "could not solve " << _jobs[i].graphFile << ": " << e.what() << std::endl;
+		}
+	}
+}
+
+void
+BatchSolver::addJobsFromManifest(
+		const std::string& manifest,
+		const std::string& resultDirectory,
+		const std::string& resultSuffix) {
+
+	boost::filesystem::path base = boost::filesystem::path(manifest).parent_path();
+
+	std::ifstream in(manifest.c_str());
+
+	std::string line;
+	while (std::getline(in, line)) {
+
+		std::stringstream ss(line);
+
+		std::string graphFile;
+		std::string factorFile;
+		ss >> graphFile >> factorFile;
+
+		if (graphFile.empty() || graphFile[0] == '#')
+			continue;
+
+		HostSolver::Job job;
+		job.graphFile  = boost::filesystem::absolute(graphFile, base).string();
+		if (!factorFile.empty())
+			job.factorFile = boost::filesystem::absolute(factorFile, base).string();
+		job.resultFile = resultFile(job.graphFile, resultDirectory, resultSuffix);
+
+		_jobs.push_back(job);
+	}
+}
+
+void
+BatchSolver::addJobsFromDirectory(
+		const std::string& directory,
+		const std::string& resultDirectory,
+		const std::string& resultSuffix) {
+
+	std::vector<boost::filesystem::path> files;
+	std::copy(
+			boost::filesystem::directory_iterator(directory),
+			boost::filesystem::directory_iterator(),
+			std::back_inserter(files));
+	std::sort(files.begin(), files.end());
+
+	for (const boost::filesystem::path& file : files) {
+
+		if (!boost::filesystem::is_regular_file(file))
+			continue;
+
+		std::string extension = file.extension().string();
+		std::string stem      = file.stem().string();
+
+		if (extension != ".dat" && extension != ".lgf")
+			continue;
+
+		// factor files are not graphs
+		if (stem.size() > 8 && stem.compare(stem.size() - 8, 8, "_factors") == 0)
+			continue;
+
+		HostSolver::Job job;
+		job.graphFile = file.string();
+
+		boost::filesystem::path factorFile = file.parent_path()/(stem + "_factors.dat");
+		if (boost::filesystem::exists(factorFile))
+			job.factorFile = factorFile.string();
+
+		job.resultFile = resultFile(job.graphFile, resultDirectory, resultSuffix);
+
+		_jobs.push_back(job);
+	}
+}
+
+std::string
+BatchSolver::resultFile(
+		const std::string& graphFile,
+		const std::string& resultDirectory,
+		const std::string& resultSuffix) {
+
+	if (resultDirectory.empty())
+		return "";
+
+	boost::filesystem::path filename = boost::filesystem::path(graphFile).filename();
+
+	return (boost::filesystem::path(resultDirectory)/(filename.string() + resultSuffix)).string();
+}
+
+} // namespace host
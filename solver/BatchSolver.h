@@ -0,0 +1,105 @@
+#ifndef HOST_SOLVER_BATCH_SOLVER_H__
+#define HOST_SOLVER_BATCH_SOLVER_H__
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include "HostSolver.h"
+
+namespace host {
+
+/**
+ * Solves a batch of HOST problems on a pool of worker threads. Each worker
+ * owns one HostSolver, such that graph and search state are reused between
+ * the problems of a worker. While the workers run, the log channels of the
+ * searches report errors only, and a summary line per problem is logged.
+ */
+class BatchSolver {
+
+public:
+
+	/**
+	 * Create a batch solver.
+	 *
+	 * @param numThreads
+	 *              The number of worker threads. If 0, one thread per
+	 *              hardware thread is used.
+	 *
+	 * @param numIterations
+	 *              The maximal number of iterations per problem.
+	 */
+	BatchSolver(unsigned int numThreads = 0, unsigned int numIterations = 100);
+
+	/**
+	 * Add jobs from a manifest file or a directory. A manifest lists one
+	 * problem per line as
+	 *
+	 *   <graph file> [<multi-edge factor file>]
+	 *
+	 * Empty lines and lines starting with '#' are ignored, relative paths are
+	 * interpreted relative to the manifest. For a directory, every *.dat and
+	 * *.lgf file is a graph. A file <name>_factors.dat next to <name>.dat is
+	 * used as its multi-edge factor file.
+	 *
+	 * If resultDirectory is not empty, the result of each problem is written
+	 * to <resultDirectory>/<graph file name><resultSuffix> (see
+	 * WeightedGraphWriter for the formats).
+	 */
+	void addJobs(
+			const std::string& manifestOrDirectory,
+			const std::string& resultDirectory = "",
+			const std::string& resultSuffix = ".bin");
+
+	/**
+	 * Add a single job.
+	 */
+	void addJob(const HostSolver::Job& job) { _jobs.push_back(job); }
+
+	/**
+	 * Solve all jobs. Returns the number of jobs that could not be solved
+	 * (i.e., that raised an exception).
+	 */
+	unsigned int solve();
+
+	/**
+	 * Print one line per job with the file name, the length of the result,
+	 * and whether the constraints are fulfilled.
+	 */
+	void printSummary(std::ostream& os) const;
+
+	const std::vector<HostSolver::Job>&    getJobs()    const { return _jobs; }
+	const std::vector<HostSolver::Result>& getResults() const { return _results; }
+
+private:
+
+	void addJobsFromManifest(const std::string& manifest, const std::string& resultDirectory, const std::string& resultSuffix);
+
+	void addJobsFromDirectory(const std::string& directory, const std::string& resultDirectory, const std::string& resultSuffix);
+
+	std::string resultFile(const std::string& graphFile, const std::string& resultDirectory, const std::string& resultSuffix);
+
+	// process jobs until none is left
+	void work();
+
+	unsigned int _numThreads;
+	unsigned int _numIterations;
+
+	std::vector<HostSolver::Job>    _jobs;
+	std::vector<HostSolver::Result> _results;
+	std::vector<char>               _failed;
+
+	// the next job to be processed by a worker
+	std::atomic<std::size_t> _nextJob;
+
+	std::atomic<unsigned int> _numFailed;
+
+	// serializes progress output of the workers
+	std::mutex _outputMutex;
+};
+
+} // namespace host
+
+#endif // HOST_SOLVER_BATCH_SOLVER_H__
+
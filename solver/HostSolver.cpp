@@ -0,0 +1,63 @@
+#include <io/WeightedGraphReader.h>
+#include <io/WeightedGraphWriter.h>
+#include <io/MultiEdgeFactorReader.h>
+#include <inference/ExplicitWeightTerm.h>
+#include <inference/CandidateConflictTerm.h>
+#include <inference/MultiEdgeFactorTerm.h>
+#include "HostSolver.h"
+
+namespace host {
+
+HostSolver::HostSolver(unsigned int numIterations) :
+	_numIterations(numIterations),
+	_weights(_graph),
+	_labels(_graph),
+	_types(_graph),
+	_mst(_graph),
+	_search(_graph) {}
+
+HostSolver::Result
+HostSolver::solve(const Job& job) {
+
+	// clearing the graph keeps the capacity of the graph and all attached arc
+	// maps
+	_graph.clear();
+	_search.clearTerms();
+
+	WeightedGraphReader graphReader(job.graphFile);
+	graphReader.fill(_graph, _weights, _labels, _types);
+
+	MultiEdgeFactors multiEdgeFactors;
+
+	if (!job.factorFile.empty()) {
+
+		MultiEdgeFactorReader factorReader(job.factorFile);
+		factorReader.fill(_graph, _labels, multiEdgeFactors);
+	}
+
+	ExplicitWeightTerm    weightTerm(_graph, _weights);
+	CandidateConflictTerm cctTerm(_graph, _types);
+	MultiEdgeFactorTerm   mefTerm(_graph, multiEdgeFactors);
+
+	_search.addTerm(&weightTerm);
+	_search.addTerm(&cctTerm);
+	_search.addTerm(&mefTerm);
+
+	Result result;
+	result.numNodes = lemon::countNodes(_graph);
+	result.numArcs  = lemon::countArcs(_graph);
+	result.constraintsFulfilled = _search.find(_mst, result.length, _numIterations);
+
+	// the terms go out of scope
+	_search.clearTerms();
+
+	if (!job.resultFile.empty()) {
+
+		WeightedGraphWriter graphWriter(job.resultFile);
+		graphWriter.write(_graph, _weights, _mst);
+	}
+
+	return result;
+}
+
+} // namespace host
@@ -0,0 +1,82 @@
+#ifndef HOST_SOLVER_HOST_SOLVER_H__
+#define HOST_SOLVER_HOST_SOLVER_H__
+
+#include <string>
+#include <graph/Graph.h>
+#include <inference/HostSearch.h>
+
+namespace host {
+
+/**
+ * Reusable state to solve a sequence of HOST problems, one after another. The
+ * graph, its arc maps, and the HostSearch are kept between calls to solve(),
+ * such that the memory allocated for one problem gets reused for the next
+ * one. Not thread-safe, use one HostSolver per thread.
+ */
+class HostSolver {
+
+public:
+
+	/**
+	 * Description of a single problem.
+	 */
+	struct Job {
+
+		// the graph file to read
+		std::string graphFile;
+
+		// optional multi-edge factor file
+		std::string factorFile;
+
+		// optional file to write the result to
+		std::string resultFile;
+	};
+
+	/**
+	 * The outcome of solving a single problem.
+	 */
+	struct Result {
+
+		Result() :
+			constraintsFulfilled(false),
+			length(0),
+			numNodes(0),
+			numArcs(0) {}
+
+		bool         constraintsFulfilled;
+		double       length;
+		unsigned int numNodes;
+		unsigned int numArcs;
+	};
+
+	HostSolver(unsigned int numIterations = 100);
+
+	/**
+	 * Read, solve, and (optionally) write the result of the given problem.
+	 */
+	Result solve(const Job& job);
+
+	/**
+	 * Access to the graph and the result of the last call to solve().
+	 */
+	const Graph&        graph()   const { return _graph; }
+	const ArcWeights&   weights() const { return _weights; }
+	const ArcSelection& mst()     const { return _mst; }
+
+private:
+
+	unsigned int _numIterations;
+
+	Graph        _graph;
+	ArcWeights   _weights;
+	ArcLabels    _labels;
+	ArcTypes     _types;
+	ArcSelection _mst;
+
+	HostSearch _search;
+};
+
+} // namespace host
+
+#endif // HOST_SOLVER_HOST_SOLVER_H__
+
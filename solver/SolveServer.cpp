@@ -0,0 +1,368 @@
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <exception>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <boost/lexical_cast.hpp>
+#include <boost/exception/diagnostic_information.hpp>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <io/WeightedGraphReader.h>
+#include <io/MultiEdgeFactorReader.h>
+#include "SolveServer.h"
+
+logger::LogChannel solveserverlog("solveserverlog", "[SolveServer] ");
+
+namespace host {
+
+SolveServer::SolveServer(
+		const std::string& graphFile,
+		const std::string& factorFile,
+		unsigned int       numIterations) :
+	_numIterations(numIterations),
+	_weights(_graph),
+	_labels(_graph),
+	_types(_graph),
+	_mst(_graph),
+	_previousMst(_graph),
+	_search(_graph),
+	_weightTerm(_graph, _weights),
+	_termsDirty(true) {
+
+	WeightedGraphReader graphReader(graphFile);
+	graphReader.fill(_graph, _weights, _labels, _types);
+
+	if (!factorFile.empty()) {
+
+		MultiEdgeFactorReader factorReader(factorFile);
+		factorReader.fill(_graph, _labels, _multiEdgeFactors);
+	}
+
+	_mefTerm.reset(new MultiEdgeFactorTerm(_graph, _multiEdgeFactors));
+
+	for (ArcIt arc(_graph); arc != lemon::INVALID; ++arc)
+		_previousMst[arc] = false;
+
+	updateTerms();
+
+	LOG_USER(solveserverlog)
+			<< "loaded " << graphFile << " with "
+			<< lemon::countNodes(_graph) << " nodes and "
+			<< lemon::countArcs(_graph) << " arcs" << std::endl;
+}
+
+void
+SolveServer::serve(const std::string& socketPath) {
+
+	sockaddr_un address;
+	std::memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+
+	if (socketPath.size() >= sizeof(address.sun_path))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"socket path " << socketPath << " is too long");
+
+	std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+	int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (server < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not create socket: " << std::strerror(errno));
+
+	::unlink(socketPath.c_str());
+
+	if (::bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+	    ::listen(server, 1) < 0) {
+
+		::close(server);
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not listen on " << socketPath << ": " << std::strerror(errno));
+	}
+
+	LOG_USER(solveserverlog) << "listening on " << socketPath << std::endl;
+
+	bool shutdown = false;
+	while (!shutdown) {
+
+		int connection = ::accept(server, 0, 0);
+
+		if (connection < 0) {
+
+			if (errno == EINTR)
+				continue;
+
+			LOG_ERROR(solveserverlog) << "accept failed: " << std::strerror(errno) << std::endl;
+			break;
+		}
+
+		LOG_DEBUG(solveserverlog) << "client connected" << std::endl;
+
+		serveConnection(connection, shutdown);
+		::close(connection);
+
+		LOG_DEBUG(solveserverlog) << "client disconnected" << std::endl;
+	}
+
+	::close(server);
+	::unlink(socketPath.c_str());
+}
+
+void
+SolveServer::serveConnection(int connection, bool& shutdown) {
+
+	std::string buffer;
+	char        chunk[4096];
+
+	while (true) {
+
+		ssize_t n = ::read(connection, chunk, sizeof(chunk));
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return;
+
+		buffer.append(chunk, n);
+
+		std::size_t newline;
+		while ((newline = buffer.find('\n')) != std::string::npos) {
+
+			std::string request = buffer.substr(0, newline);
+			buffer.erase(0, newline + 1);
+
+			bool closeConnection = false;
+			std::string response = handle(request, closeConnection, shutdown);
+			response += "end\n";
+
+			const char* data = response.c_str();
+			std::size_t left = response.size();
+			while (left > 0) {
+
+				// a client that is gone must not kill the server with SIGPIPE
+				ssize_t written = ::send(connection, data, left, MSG_NOSIGNAL);
+
+				if (written < 0 && errno == EINTR)
+					continue;
+				if (written <= 0)
+					return;
+
+				data += written;
+				left -= written;
+			}
+
+			if (closeConnection || shutdown)
+				return;
+		}
+	}
+}
+
+std::string
+SolveServer::handle(const std::string& request, bool& closeConnection, bool& shutdown) {
+
+	std::stringstream ss(request);
+	std::string command;
+	ss >> command;
+
+	LOG_DEBUG(solveserverlog) << "got request '" << request << "'" << std::endl;
+
+	try {
+
+		if (command == "weight") {
+
+			int u, v;
+			double weight;
+			if (!(ss >> u >> v >> weight))
+				return "error usage: weight <u> <v> <w>\n";
+
+			return setWeight(u, v, weight);
+		}
+
+		if (command == "conflict") {
+
+			std::string action;
+			int u, v;
+			if (!(ss >> action >> u >> v) || (action != "add" && action != "remove"))
+				return "error usage: conflict add|remove <u> <v>\n";
+
+			if (action == "add")
+				return addConflict(u, v);
+			return removeConflict(u, v);
+		}
+
+		if (command == "solve") {
+
+			double       timeBudget    = 0;
+			unsigned int numIterations = _numIterations;
+
+			if (ss >> timeBudget)
+				ss >> numIterations;
+
+			return solve(timeBudget/1000.0, numIterations);
+		}
+
+		if (command == "quit") {
+
+			closeConnection = true;
+			return "ok\n";
+		}
+
+		if (command == "shutdown") {
+
+			shutdown = true;
+			return "ok\n";
+		}
+
+	} catch (boost::exception& e) {
+
+		return "error " + boost::diagnostic_information(e) + "\n";
+
+	} catch (std::exception& e) {
+
+		return "error " + std::string(e.what()) + "\n";
+	}
+
+	return "error unknown command '" + command + "'\n";
+}
+
+std::string
+SolveServer::setWeight(int u, int v, double weight) {
+
+	Arc arc = findArc(u, v, Link);
+
+	if (arc == lemon::INVALID)
+		return "error no link arc from " + boost::lexical_cast<std::string>(u) + " to " + boost::lexical_cast<std::string>(v) + "\n";
+
+	_weights[arc] = weight;
+
+	if (_graph.isUndirected()) {
+
+		Arc opposite = findArc(v, u, Link);
+		if (opposite != lemon::INVALID)
+			_weights[opposite] = weight;
+	}
+
+	return "ok\n";
+}
+
+std::string
+SolveServer::addConflict(int u, int v) {
+
+	if (!validNode(u) || !validNode(v) || u == v)
+		return "error invalid nodes for conflict\n";
+
+	if (findArc(u, v, Conflict) != lemon::INVALID)
+		return "ok\n";
+
+	// conflicts are always symmetric (see WeightedGraphReader)
+	Arc arc      = _graph.addArc(_graph.nodeFromId(u), _graph.nodeFromId(v));
+	Arc opposite = _graph.addArc(_graph.nodeFromId(v), _graph.nodeFromId(u));
+
+	std::string label = "conflict_" + boost::lexical_cast<std::string>(u) + "_" + boost::lexical_cast<std::string>(v);
+
+	_weights[arc]      = _weights[opposite] = 0;
+	_types[arc]        = _types[opposite]   = Conflict;
+	_labels[arc]       = label;
+	_labels[opposite]  = label + "_opp";
+	_previousMst[arc]  = _previousMst[opposite] = false;
+
+	_termsDirty = true;
+
+	return "ok\n";
+}
+
+std::string
+SolveServer::removeConflict(int u, int v) {
+
+	if (!validNode(u) || !validNode(v))
+		return "error invalid nodes for conflict\n";
+
+	Arc arc      = findArc(u, v, Conflict);
+	Arc opposite = findArc(v, u, Conflict);
+
+	if (arc == lemon::INVALID && opposite == lemon::INVALID)
+		return "error no conflict between " + boost::lexical_cast<std::string>(u) + " and " + boost::lexical_cast<std::string>(v) + "\n";
+
+	// the conflict term refers to these arcs, drop it before erasing them
+	_cctTerm.reset();
+	_termsDirty = true;
+
+	if (arc != lemon::INVALID)
+		_graph.erase(arc);
+	if (opposite != lemon::INVALID)
+		_graph.erase(opposite);
+
+	return "ok\n";
+}
+
+std::string
+SolveServer::solve(double timeBudget, unsigned int numIterations) {
+
+	if (_termsDirty)
+		updateTerms();
+
+	double length;
+
+	_search.setTimeLimit(timeBudget);
+	bool constraintsFulfilled = _search.find(_mst, length, numIterations);
+
+	std::stringstream response;
+
+	for (ArcIt arc(_graph); arc != lemon::INVALID; ++arc) {
+
+		if (_mst[arc] == _previousMst[arc])
+			continue;
+
+		response
+				<< (_mst[arc] ? "+ " : "- ")
+				<< _graph.id(_graph.source(arc)) << " "
+				<< _graph.id(_graph.target(arc)) << "\n";
+
+		_previousMst[arc] = _mst[arc];
+	}
+
+	response << "value " << length << " " << constraintsFulfilled << "\n";
+
+	return response.str();
+}
+
+Arc
+SolveServer::findArc(int u, int v, ArcType type) {
+
+	if (!validNode(u) || !validNode(v))
+		return lemon::INVALID;
+
+	Node target = _graph.nodeFromId(v);
+
+	for (OutArcIt arc(_graph, _graph.nodeFromId(u)); arc != lemon::INVALID; ++arc)
+		if (_graph.target(arc) == target && _types[arc] == type)
+			return arc;
+
+	return lemon::INVALID;
+}
+
+bool
+SolveServer::validNode(int id) {
+
+	return id >= 0 && id <= _graph.maxNodeId() && _graph.valid(_graph.nodeFromId(id));
+}
+
+void
+SolveServer::updateTerms() {
+
+	_search.clearTerms();
+
+	_cctTerm.reset(new CandidateConflictTerm(_graph, _types));
+
+	_search.addTerm(&_weightTerm);
+	_search.addTerm(_cctTerm.get());
+	_search.addTerm(_mefTerm.get());
+
+	_termsDirty = false;
+}
+
+} // namespace host
@@ -0,0 +1,113 @@
+#ifndef HOST_SOLVER_SOLVE_SERVER_H__
+#define HOST_SOLVER_SOLVE_SERVER_H__
+
+#include <string>
+#include <memory>
+#include <graph/Graph.h>
+#include <inference/HostSearch.h>
+#include <inference/ExplicitWeightTerm.h>
+#include <inference/CandidateConflictTerm.h>
+#include <inference/MultiEdgeFactorTerm.h>
+
+namespace host {
+
+/**
+ * A resident solver that keeps a graph and its terms in memory and accepts
+ * modification and solve requests over a Unix domain socket. Requests are
+ * single lines, the response to each request is a sequence of lines
+ * terminated by a line "end":
+ *
+ *   weight <u> <v> <w>
+ *
+ *     set the weight of the link arc from node u to node v (and of the
+ *     opposite arc, if the graph is undirected) to w
+ *
+ *   conflict add <u> <v>
+ *   conflict remove <u> <v>
+ *
+ *     add or remove a conflict between nodes u and v
+ *
+ *   solve [<time budget in ms> [<max iterations>]]
+ *
+ *     re-solve, respond with the arcs that entered ("+ <u> <v>") and left
+ *     ("- <u> <v>") the arborescence since the last solve, followed by
+ *     "value <length> <constraints fulfilled>"
+ *
+ *   quit
+ *
+ *     close the connection
+ *
+ *   shutdown
+ *
+ *     close the connection and stop the server
+ *
+ * Errors are reported as "error <message>".
+ */
+class SolveServer {
+
+public:
+
+	SolveServer(
+			const std::string& graphFile,
+			const std::string& factorFile = "",
+			unsigned int       numIterations = 100);
+
+	/**
+	 * Listen on the given socket path and process requests until a
+	 * "shutdown" request was received. Clients are served one after another.
+	 */
+	void serve(const std::string& socketPath);
+
+	/**
+	 * Process a single request and return the response (without the
+	 * terminating "end" line). Sets closeConnection to true, if the client
+	 * wants to disconnect, and shutdown to true, if the server should stop.
+	 */
+	std::string handle(const std::string& request, bool& closeConnection, bool& shutdown);
+
+private:
+
+	std::string setWeight(int u, int v, double weight);
+
+	std::string addConflict(int u, int v);
+
+	std::string removeConflict(int u, int v);
+
+	std::string solve(double timeBudget, unsigned int numIterations);
+
+	// find the arc between two nodes with the given type
+	Arc findArc(int u, int v, ArcType type);
+
+	// check whether the given id is a valid node id
+	bool validNode(int id);
+
+	// rebuild the terms that depend on the graph structure
+	void updateTerms();
+
+	void serveConnection(int connection, bool& shutdown);
+
+	unsigned int _numIterations;
+
+	Graph        _graph;
+	ArcWeights   _weights;
+	ArcLabels    _labels;
+	ArcTypes     _types;
+	ArcSelection _mst;
+	ArcSelection _previousMst;
+
+	MultiEdgeFactors _multiEdgeFactors;
+
+	HostSearch _search;
+
+	ExplicitWeightTerm                     _weightTerm;
+	std::unique_ptr<CandidateConflictTerm> _cctTerm;
+	std::unique_ptr<MultiEdgeFactorTerm>   _mefTerm;
+
+	// the conflict term needs to be rebuilt before the next solve
+	bool _termsDirty;
+};
+
+} // namespace host
+
+#endif // HOST_SOLVER_SOLVE_SERVER_H__
+
@@ -0,0 +1,185 @@
+#include <map>
+#include <algorithm>
+#include <vector>
+#include <utility>
+#include <tests.h>
+#include <tubes/io/Hdf5GraphWriter.h>
+#include <tubes/io/Hdf5GraphReader.h>
+
+namespace hdf5_edge_maps_case {
+
+typedef lemon::ListGraph Graph;
+
+// stores a point list as consecutive floats
+struct PointConverter {
+
+	typedef float ArrayValueType;
+	static const int ArraySize = 3;
+
+	void operator()(const std::vector<float>& p, float* array) const {
+
+		for (int i = 0; i < 3; i++)
+			array[i] = p[i];
+	}
+
+	std::vector<float> operator()(const float* array) const {
+
+		return std::vector<float>(array, array + 3);
+	}
+};
+
+typedef std::vector<std::vector<float>> Points;
+
+// the values of all edges, identified by the node labels of their end points
+struct Contents {
+
+	std::map<std::pair<int, int>, double> weights;
+	std::map<std::pair<int, int>, Points> points;
+};
+
+std::pair<int, int> key(const Graph& graph, const Graph::NodeMap<int>& labels, const Graph::Edge& edge) {
+
+	int u = labels[graph.u(edge)];
+	int v = labels[graph.v(edge)];
+
+	return std::make_pair(std::min(u, v), std::max(u, v));
+}
+
+Contents contents(
+		const Graph&                  graph,
+		const Graph::NodeMap<int>&    labels,
+		const Graph::EdgeMap<double>& weights,
+		const Graph::EdgeMap<Points>& points) {
+
+	Contents c;
+	for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
+
+		c.weights[key(graph, labels, edge)] = weights[edge];
+		c.points[key(graph, labels, edge)]  = points[edge];
+	}
+
+	return c;
+}
+
+void write(
+		vigra::HDF5File&              file,
+		const Graph&                  graph,
+		const Graph::NodeMap<int>&    labels,
+		const Graph::EdgeMap<double>& weights,
+		const Graph::EdgeMap<Points>& points) {
+
+	Hdf5GraphWriter writer(file);
+	writer.writeGraph(graph);
+	writer.writeNodeMap(graph, labels, "labels");
+	writer.writeEdgeMap(graph, weights, "weights");
+	writer.writeVarLengthEdgeMap(graph, points, "points", PointConverter());
+}
+
+void read(
+		vigra::HDF5File&        file,
+		Graph&                  graph,
+		Graph::NodeMap<int>&    labels,
+		Graph::EdgeMap<double>& weights,
+		Graph::EdgeMap<Points>& points) {
+
+	Hdf5GraphReader reader(file);
+	reader.readGraph(graph);
+	reader.readNodeMap(graph, labels, "labels");
+	reader.readEdgeMap(graph, weights, "weights");
+	reader.readVarLengthEdgeMap(graph, points, "points", PointConverter());
+}
+
+void check(const Contents& expected, const Contents& actual) {
+
+	BOOST_REQUIRE_EQUAL(expected.weights.size(), actual.weights.size());
+	BOOST_REQUIRE_EQUAL(expected.points.size(), actual.points.size());
+
+	for (const auto& p : expected.weights) {
+
+		BOOST_REQUIRE(actual.weights.count(p.first));
+		BOOST_CHECK_EQUAL(actual.weights.at(p.first), p.second);
+	}
+
+	for (const auto& p : expected.points) {
+
+		BOOST_REQUIRE(actual.points.count(p.first));
+
+		const Points& points = actual.points.at(p.first);
+		BOOST_REQUIRE_EQUAL(points.size(), p.second.size());
+		for (std::size_t i = 0; i < points.size(); i++)
+			BOOST_CHECK(points[i] == p.second[i]);
+	}
+}
+
+} using namespace hdf5_edge_maps_case;
+
+void hdf5_edge_maps() {
+
+	// a graph with gaps in its node and edge ids, and edges with no, one, and
+	// several points
+
+	Graph                  graph;
+	Graph::NodeMap<int>    labels(graph);
+	Graph::EdgeMap<double> weights(graph);
+	Graph::EdgeMap<Points> points(graph);
+
+	std::vector<Graph::Node> nodes;
+	for (int i = 0; i < 6; i++) {
+
+		nodes.push_back(graph.addNode());
+		labels[nodes.back()] = 10*i;
+	}
+
+	for (int i = 0; i < 6; i++)
+		for (int j = i + 1; j < 6; j += 2) {
+
+			Graph::Edge edge = graph.addEdge(nodes[i], nodes[j]);
+			weights[edge] = 0.5*i + j;
+
+			for (int k = 0; k < (i + j)%4; k++)
+				points[edge].push_back({
+						static_cast<float>(i),
+						static_cast<float>(j),
+						static_cast<float>(k)});
+		}
+
+	graph.erase(nodes[2]);
+	graph.erase(graph.edgeFromId(1));
+
+	Contents expected = contents(graph, labels, weights, points);
+	BOOST_REQUIRE(expected.weights.size() > 0);
+
+	boost::filesystem::path filename =
+			boost::filesystem::temp_directory_path()/
+			boost::filesystem::unique_path("hdf5_edge_maps_%%%%%%%%.hdf");
+
+	{
+		vigra::HDF5File file(filename.native(), vigra::HDF5File::New);
+
+		// write, read, write again, and read again
+
+		file.cd_mk("/first");
+		write(file, graph, labels, weights, points);
+
+		Graph                  read1;
+		Graph::NodeMap<int>    labels1(read1);
+		Graph::EdgeMap<double> weights1(read1);
+		Graph::EdgeMap<Points> points1(read1);
+		read(file, read1, labels1, weights1, points1);
+
+		check(expected, contents(read1, labels1, weights1, points1));
+
+		file.cd_mk("/second");
+		write(file, read1, labels1, weights1, points1);
+
+		Graph                  read2;
+		Graph::NodeMap<int>    labels2(read2);
+		Graph::EdgeMap<double> weights2(read2);
+		Graph::EdgeMap<Points> points2(read2);
+		read(file, read2, labels2, weights2, points2);
+
+		check(expected, contents(read2, labels2, weights2, points2));
+	}
+
+	boost::filesystem::remove(filename);
+}
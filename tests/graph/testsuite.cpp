@@ -3,5 +3,6 @@
 BEGIN_TEST_SUITE(graph)
 
 	ADD_TEST_CASE(read_graph)
+	ADD_TEST_CASE(hdf5_edge_maps)
 
 END_TEST_SUITE()
@@ -0,0 +1,154 @@
+#include <deque>
+#include <random>
+#include <vector>
+#include <tests.h>
+#include <pipeline/Process.h>
+#include <pipeline/Value.h>
+#include <imageprocessing/ImageStack.h>
+#include <volumes/ExtractLabels.h>
+
+namespace extract_labels_case {
+
+std::vector<const Image*> sectionsOf(const ImageStack& stack) {
+
+	std::vector<const Image*> sections;
+	foreach (boost::shared_ptr<Image> image, stack)
+		sections.push_back(image.get());
+
+	return sections;
+}
+
+// label the 6-connected components of equal, non-zero values with a
+// breadth-first search, numbered by their first voxel in scan order
+std::vector<int> referenceLabels(const ImageStack& stack) {
+
+	int width  = stack.width();
+	int height = stack.height();
+	int depth  = stack.size();
+
+	std::vector<const Image*> sections = sectionsOf(stack);
+
+	auto value = [&](int x, int y, int z) { return (*sections[z])(x, y); };
+	auto index = [&](int x, int y, int z) { return (z*height + y)*width + x; };
+
+	std::vector<int> labels(width*height*depth, 0);
+	int              numComponents = 0;
+
+	for (int z = 0; z < depth; z++)
+	for (int y = 0; y < height; y++)
+	for (int x = 0; x < width; x++) {
+
+		if (value(x, y, z) == 0 || labels[index(x, y, z)] != 0)
+			continue;
+
+		int label = ++numComponents;
+
+		std::deque<vigra::Shape3> queue;
+		queue.push_back(vigra::Shape3(x, y, z));
+		labels[index(x, y, z)] = label;
+
+		while (!queue.empty()) {
+
+			vigra::Shape3 p = queue.front();
+			queue.pop_front();
+
+			const int neighbors[6][3] = {
+				{-1, 0, 0}, {1, 0, 0},
+				{0, -1, 0}, {0, 1, 0},
+				{0, 0, -1}, {0, 0, 1}
+			};
+
+			for (const int* d : neighbors) {
+
+				int nx = p[0] + d[0];
+				int ny = p[1] + d[1];
+				int nz = p[2] + d[2];
+
+				if (nx < 0 || ny < 0 || nz < 0 || nx >= width || ny >= height || nz >= depth)
+					continue;
+
+				if (labels[index(nx, ny, nz)] != 0 || value(nx, ny, nz) != value(p[0], p[1], p[2]))
+					continue;
+
+				labels[index(nx, ny, nz)] = label;
+				queue.push_back(vigra::Shape3(nx, ny, nz));
+			}
+		}
+	}
+
+	return labels;
+}
+
+boost::shared_ptr<ImageStack> randomStack(int width, int height, int depth, int numValues, double density, unsigned int seed) {
+
+	std::mt19937                           random(seed);
+	std::uniform_real_distribution<double> foreground(0, 1);
+	std::uniform_int_distribution<int>     values(1, numValues);
+
+	boost::shared_ptr<ImageStack> stack = boost::make_shared<ImageStack>();
+
+	for (int z = 0; z < depth; z++) {
+
+		boost::shared_ptr<Image> image = boost::make_shared<Image>(width, height);
+
+		for (int y = 0; y < height; y++)
+		for (int x = 0; x < width; x++)
+			(*image)(x, y) = (foreground(random) < density ? values(random) : 0);
+
+		stack->add(image);
+	}
+
+	return stack;
+}
+
+void check(boost::shared_ptr<ImageStack> stack) {
+
+	pipeline::Process<ExtractLabels> extractLabels;
+	extractLabels->setInput(stack);
+
+	pipeline::Value<ImageStack> labelStack = extractLabels->getOutput();
+
+	std::vector<int> expected = referenceLabels(*stack);
+
+	BOOST_REQUIRE_EQUAL(labelStack->size(), stack->size());
+
+	int width  = stack->width();
+	int height = stack->height();
+
+	std::vector<const Image*> labels = sectionsOf(*labelStack);
+
+	for (unsigned int z = 0; z < labels.size(); z++)
+	for (int y = 0; y < height; y++)
+	for (int x = 0; x < width; x++)
+		BOOST_REQUIRE_EQUAL((*labels[z])(x, y), expected[(z*height + y)*width + x]);
+}
+
+} using namespace extract_labels_case;
+
+void extract_labels() {
+
+	// deep enough for several slabs, such that components are merged across
+	// slab boundaries; dense stacks have components that span many slabs,
+	// sparse ones many small components
+
+	check(randomStack(7, 5, 1, 1, 0.6, 1));
+	check(randomStack(7, 5, 23, 1, 0.6, 2));
+	check(randomStack(13, 11, 37, 2, 0.8, 3));
+	check(randomStack(9, 9, 64, 3, 0.3, 4));
+	check(randomStack(16, 8, 41, 1, 0.95, 5));
+
+	// a staircase in z, whose sections are connected only through the
+	// sections before and after them
+	boost::shared_ptr<ImageStack> stack = randomStack(4, 4, 32, 1, 0, 0);
+	int z = 0;
+	foreach (boost::shared_ptr<Image> image, *stack) {
+
+		(*image)(z%4, 0)       = 1;
+		(*image)((z + 1)%4, 0) = 1;
+		z++;
+	}
+	check(stack);
+
+	// empty stacks have no components
+	check(randomStack(5, 5, 9, 1, 0, 6));
+}
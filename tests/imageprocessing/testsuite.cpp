@@ -2,4 +2,6 @@
 
 BEGIN_TEST_SUITE(imageprocessing)
 
+	ADD_TEST_CASE(extract_labels)
+
 END_TEST_SUITE()
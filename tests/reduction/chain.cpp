@@ -0,0 +1,90 @@
+#include <tests.h>
+#include <io/WeightedGraphReader.h>
+#include <inference/ExplicitWeightTerm.h>
+#include <inference/CandidateConflictTerm.h>
+#include <inference/GraphReduction.h>
+#include <inference/HostSearch.h>
+
+namespace chain_case {
+
+double solve(const host::Graph& graph, const host::ArcWeights& weights, const host::ArcTypes& types, host::ArcSelection& mst) {
+
+	host::ExplicitWeightTerm    edgeWeightsTerm(graph, weights);
+	host::CandidateConflictTerm conflictsTerm(graph, types);
+
+	host::HostSearch search(graph);
+	search.addTerm(&edgeWeightsTerm);
+	search.addTerm(&conflictsTerm);
+
+	double value;
+	bool optimal = search.find(mst, value);
+
+	BOOST_CHECK(optimal);
+
+	return value;
+}
+
+} using namespace chain_case;
+
+void chain() {
+
+	boost::filesystem::path dataDir = dir_of(__FILE__);
+	boost::filesystem::path graphfile = dataDir/"chain.dat";
+
+	host::Graph            graph;
+	host::ArcWeights       weights(graph);
+	host::ArcLabels        labels(graph);
+	host::ArcTypes         types(graph);
+
+	host::WeightedGraphReader reader(graphfile.native());
+	reader.fill(graph, weights, labels, types);
+
+	host::Graph            reducedGraph;
+	host::ArcWeights       reducedWeights(reducedGraph);
+	host::ArcLabels        reducedLabels(reducedGraph);
+	host::ArcTypes         reducedTypes(reducedGraph);
+
+	host::GraphReduction reduction(graph, weights, labels, types);
+	reduction.reduce(reducedGraph, reducedWeights, reducedLabels, reducedTypes);
+
+	// node 7 is unreachable, a and e are dominated by b and the contracted d, 
+	// b, c, and f are forced
+	const host::GraphReduction::Statistics& statistics = reduction.getStatistics();
+	BOOST_CHECK_EQUAL(statistics.numUnreachableNodes, 1);
+	BOOST_CHECK_EQUAL(statistics.numDominatedArcs, 2);
+	BOOST_CHECK_EQUAL(statistics.numForcedArcs, 3);
+	BOOST_CHECK_EQUAL(statistics.numReducedNodes, 4);
+	BOOST_CHECK_EQUAL(statistics.numReducedArcs, 6);
+	BOOST_CHECK_CLOSE(reduction.getOffset(), 0.9, 1e-6);
+
+	host::ArcSelection mst(graph);
+	host::ArcSelection reducedMst(reducedGraph);
+	host::ArcSelection expandedMst(graph);
+
+	double value        = solve(graph, weights, types, mst);
+	double reducedValue = solve(reducedGraph, reducedWeights, reducedTypes, reducedMst);
+
+	BOOST_CHECK_CLOSE(value, reducedValue + reduction.getOffset(), 1e-6);
+
+	reduction.expand(reducedMst, expandedMst);
+
+	// the expanded solution has to be an arborescence of the same length
+	double expandedValue = 0;
+	for (host::NodeIt node(graph); node != lemon::INVALID; ++node) {
+
+		if (node == graph.getRoot() || graph.id(node) == 7)
+			continue;
+
+		unsigned int numIn = 0;
+		for (host::InArcIt arc(graph, node); arc != lemon::INVALID; ++arc)
+			if (expandedMst[arc]) {
+
+				numIn++;
+				expandedValue += weights[arc];
+			}
+
+		BOOST_CHECK_EQUAL(numIn, 1);
+	}
+
+	BOOST_CHECK_CLOSE(value, expandedValue, 1e-6);
+}
@@ -0,0 +1,7 @@
+#include <tests.h>
+
+BEGIN_TEST_SUITE(reduction)
+
+	ADD_TEST_CASE(chain)
+
+END_TEST_SUITE()
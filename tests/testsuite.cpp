@@ -11,6 +11,7 @@ BEGIN_TEST_MODULE(host)
 	ADD_TEST_SUITE(multi_factors);
 	ADD_TEST_SUITE(gap);
 	ADD_TEST_SUITE(imageprocessing);
+	ADD_TEST_SUITE(reduction);
 
 END_TEST_MODULE()
 
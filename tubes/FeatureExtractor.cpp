@@ -1,7 +1,24 @@
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <future>
+#include <iterator>
+#include <vigra/functorexpression.hxx>
 #include <region_features/RegionFeatures.h>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
 #include <util/timing.h>
+#include <volumes/ParallelFor.h>
 #include "FeatureExtractor.h"
 
+logger::LogChannel featureextractorlog("featureextractorlog", "[FeatureExtractor] ");
+
+util::ProgramOption optionFeatureSaveBatchSize(
+		util::_long_name        = "featureSaveBatchSize",
+		util::_description_text = "The number of tubes to extract features for at a time. The features of a batch are written to "
+		                          "the tube store while the next batch is processed.",
+		util::_default_value    = 1000);
+
 void
 FeatureExtractor::extractFrom(
 		const ExplicitVolume<float>& intensities,
@@ -28,10 +45,202 @@ FeatureExtractor::extractFrom(
 
 void
 FeatureExtractor::extractFrom(
-		const ExplicitVolume<float>& /*intensities*/,
-		const Volumes&               /*volumes*/) {
+		const ExplicitVolume<float>& intensities,
+		const Volumes&               volumes) {
+
+	UTIL_TIME_METHOD;
+
+	std::size_t batchSize = std::max<std::size_t>(optionFeatureSaveBatchSize.as<std::size_t>(), 1);
+
+	// get direct access to the volumes, such that threads don't touch the map
+	std::vector<std::pair<TubeId, const ExplicitVolume<unsigned char>*>> tubes;
+	for (auto& p : volumes)
+		tubes.push_back(std::make_pair(p.first, &p.second));
+
+	LOG_USER(featureextractorlog)
+			<< "extracting features for " << tubes.size() << " tubes on "
+			<< getNumThreads() << " threads" << std::endl;
+
+	std::size_t numBatches = (tubes.size() + batchSize - 1)/batchSize;
+
+	extractBatches(numBatches, [&](std::size_t b) {
+
+		auto batch = std::make_shared<TubeBatch>();
+
+		std::size_t end = std::min(tubes.size(), (b + 1)*batchSize);
+		for (std::size_t i = b*batchSize; i < end; i++) {
+
+			batch->ids.push_back(tubes[i].first);
+			batch->tubes.push_back(tubes[i].second);
+			batch->intensities.push_back(&intensities);
+		}
+
+		return batch;
+	});
+}
+
+void
+FeatureExtractor::extractFrom(
+		VolumeStore&   volumeStore,
+		const TubeIds& ids) {
+
+	UTIL_TIME_METHOD;
+
+	std::size_t batchSize = std::max<std::size_t>(optionFeatureSaveBatchSize.as<std::size_t>(), 1);
+
+	std::vector<TubeIds> batchIds;
+	for (TubeId id : ids) {
+
+		if (batchIds.empty() || batchIds.back().size() == batchSize)
+			batchIds.push_back(TubeIds());
+		batchIds.back().add(id);
+	}
+
+	LOG_USER(featureextractorlog)
+			<< "extracting features for " << ids.size() << " tubes in "
+			<< batchIds.size() << " batches on " << getNumThreads() << " threads" << std::endl;
+
+	extractBatches(batchIds.size(), [&](std::size_t b) {
+
+		auto batch = std::make_shared<TubeBatch>();
+
+		_store->retrieveVolumes(batchIds[b], batch->volumes);
+
+		// read only the intensities covered by each tube
+		for (auto& p : batch->volumes) {
+
+			batch->intensityStorage.push_back(ExplicitVolume<float>());
+			volumeStore.retrieveIntensities(p.second.getBoundingBox(), batch->intensityStorage.back());
+
+			batch->ids.push_back(p.first);
+			batch->tubes.push_back(&p.second);
+			batch->intensities.push_back(&batch->intensityStorage.back());
+		}
+
+		return batch;
+	});
+}
+
+void
+FeatureExtractor::extractBatches(
+		std::size_t                                            numBatches,
+		std::function<std::shared_ptr<TubeBatch>(std::size_t)> prepare) {
+
+	std::vector<std::string> featureNames;
+
+	// the features of the previous batch, computed while the current one is 
+	// prepared
+	std::future<Features> computed;
+
+	for (std::size_t b = 0; b < numBatches; b++) {
+
+		std::shared_ptr<TubeBatch> batch = prepare(b);
+
+		Features previous;
+		bool     havePrevious = computed.valid();
+		if (havePrevious)
+			previous = computed.get();
+
+		computed = std::async(std::launch::async, [this, batch, &featureNames]() {
+
+			return extractBatch(*batch, featureNames);
+		});
+
+		// saved while the current batch is computed
+		if (havePrevious)
+			_store->saveFeatures(previous);
+	}
+
+	if (computed.valid()) {
+
+		Features features = computed.get();
+		_store->saveFeatures(features);
+	}
+
+	if (!featureNames.empty())
+		_store->saveFeatureNames(featureNames);
+}
+
+Features
+FeatureExtractor::extractBatch(
+		const TubeBatch&          batch,
+		std::vector<std::string>& featureNames) {
+
+	std::vector<std::vector<double>> tubeFeatures(batch.ids.size());
+	std::mutex                       namesMutex;
+
+	parallelFor(0, batch.ids.size(), [&](std::size_t i) {
+
+		std::vector<std::string> names;
+		tubeFeatures[i] = extractTubeFeatures(*batch.intensities[i], *batch.tubes[i], batch.ids[i], names);
+
+		std::lock_guard<std::mutex> lock(namesMutex);
+		if (featureNames.empty())
+			featureNames = names;
+	});
+
+	std::vector<std::pair<TubeId, std::vector<double>>> pairs;
+	pairs.reserve(batch.ids.size());
+
+	for (std::size_t i = 0; i < batch.ids.size(); i++) {
+
+		// tubes with an empty volume have no features
+		if (tubeFeatures[i].empty())
+			continue;
+
+		pairs.push_back(std::make_pair(batch.ids[i], std::move(tubeFeatures[i])));
+	}
+
+	Features features;
+	features.insert(std::make_move_iterator(pairs.begin()), std::make_move_iterator(pairs.end()));
+
+	return features;
+}
+
+std::vector<double>
+FeatureExtractor::extractTubeFeatures(
+		const ExplicitVolume<float>&         intensities,
+		const ExplicitVolume<unsigned char>& volume,
+		TubeId                               id,
+		std::vector<std::string>&            featureNames) {
+
+	UTIL_ASSERT_REL(intensities.getResolutionX(), ==, volume.getResolutionX());
+	UTIL_ASSERT_REL(intensities.getResolutionY(), ==, volume.getResolutionY());
+	UTIL_ASSERT_REL(intensities.getResolutionZ(), ==, volume.getResolutionZ());
+
+	// the position of the tube in the intensity volume
+	vigra::Shape3 begin(
+			std::round((volume.getOffset().x() - intensities.getOffset().x())/intensities.getResolutionX()),
+			std::round((volume.getOffset().y() - intensities.getOffset().y())/intensities.getResolutionY()),
+			std::round((volume.getOffset().z() - intensities.getOffset().z())/intensities.getResolutionZ()));
+	vigra::Shape3 end = begin + volume.data().shape();
+
+	if (!intensities.data().isInside(begin) || !intensities.data().isInside(end - vigra::Shape3(1, 1, 1)))
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"tube " << id << " is not contained in the intensity volume");
+
+	// the cropped intensities and the tube as label image
+	vigra::MultiArray<3, float> croppedIntensities(intensities.data().subarray(begin, end));
+	vigra::MultiArray<3, int>   labels(volume.data().shape());
+
+	vigra::transformMultiArray(
+			volume.data(),
+			labels,
+			vigra::functor::ifThenElse(
+					vigra::functor::Arg1() != vigra::functor::Param(0),
+					vigra::functor::Param(static_cast<int>(id)),
+					vigra::functor::Param(0)));
+
+	RegionFeatures<3, float, int> regionFeatures(croppedIntensities, labels);
+
+	Features features;
+	regionFeatures.fill(features);
+
+	featureNames = regionFeatures.getFeatureNames();
+
+	if (!features.contains(id))
+		return std::vector<double>();
 
-	UTIL_THROW_EXCEPTION(
-			NotYetImplemented,
-			"");
+	return std::move(features[id]);
 }
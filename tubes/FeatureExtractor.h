@@ -1,7 +1,11 @@
 #ifndef HOST_TUBES_FEATURE_EXTRACTOR_H__
 #define HOST_TUBES_FEATURE_EXTRACTOR_H__
 
+#include <deque>
+#include <memory>
+#include <functional>
 #include <util/assert.h>
+#include <volumes/io/VolumeStore.h>
 #include <tubes/io/TubeStore.h>
 
 class FeatureExtractor {
@@ -21,14 +25,59 @@ public:
 			const ExplicitVolume<int>&   labels);
 
 	/**
-	 * Extract features for a set of tubes given as individual volumes.
+	 * Extract features for a set of tubes given as individual volumes. The 
+	 * tubes are processed in parallel, each on the part of the intensity 
+	 * volume it covers. Features are saved in batches while the extraction is 
+	 * running.
 	 */
 	void extractFrom(
 			const ExplicitVolume<float>& intensities,
 			const Volumes&               volumes);
 
+	/**
+	 * Extract features for the given tubes, reading their volumes from the 
+	 * tube store and the intensities each of them covers from the given 
+	 * volume store. Tubes are read in batches (see program option 
+	 * featureSaveBatchSize), the next batch is read while the features of the 
+	 * current one are computed. Both stores are only used from the calling 
+	 * thread.
+	 */
+	void extractFrom(
+			VolumeStore&   volumeStore,
+			const TubeIds& ids);
+
 private:
 
+	// a batch of tubes and the intensities each of them is to be extracted on
+	struct TubeBatch {
+
+		std::vector<TubeId>                               ids;
+		std::vector<const ExplicitVolume<unsigned char>*> tubes;
+		std::vector<const ExplicitVolume<float>*>         intensities;
+
+		// storage for batches read from the stores
+		Volumes                           volumes;
+		std::deque<ExplicitVolume<float>> intensityStorage;
+	};
+
+	// extract and save the features of all batches, computing one batch while 
+	// the next one is prepared
+	void extractBatches(
+			std::size_t                                            numBatches,
+			std::function<std::shared_ptr<TubeBatch>(std::size_t)> prepare);
+
+	// compute the features of the tubes of a batch in parallel
+	Features extractBatch(
+			const TubeBatch&          batch,
+			std::vector<std::string>& featureNames);
+
+	// compute the features of a single tube on its bounding box
+	std::vector<double> extractTubeFeatures(
+			const ExplicitVolume<float>&         intensities,
+			const ExplicitVolume<unsigned char>& volume,
+			TubeId                               id,
+			std::vector<std::string>&            featureNames);
+
 	TubeStore* _store;
 };
 
@@ -0,0 +1,69 @@
+#include <iterator>
+#include <util/exceptions.h>
+#include "FeatureMatrix.h"
+
+FeatureMatrix::FeatureMatrix(const Features& features) :
+	_numFeatures(features.size() > 0 ? features.begin()->second.size() : 0) {
+
+	reserve(features.size());
+
+	for (auto& p : features) {
+
+		if (p.second.size() != _numFeatures)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"tube " << p.first << " has " << p.second.size() << " features, expected " << _numFeatures);
+
+		std::size_t i = addTube(p.first);
+		std::copy(p.second.begin(), p.second.end(), row(i));
+	}
+}
+
+void
+FeatureMatrix::reserve(std::size_t numTubes) {
+
+	_ids.reserve(numTubes);
+	_data.reserve(numTubes*_numFeatures);
+	_rows.reserve(numTubes);
+}
+
+std::size_t
+FeatureMatrix::addTube(TubeId id) {
+
+	auto i = _rows.find(id);
+	if (i != _rows.end())
+		return i->second;
+
+	std::size_t row = _ids.size();
+
+	_ids.push_back(id);
+	_data.resize(_data.size() + _numFeatures, 0.0);
+	_rows[id] = row;
+
+	return row;
+}
+
+std::size_t
+FeatureMatrix::getRow(TubeId id) const {
+
+	auto i = _rows.find(id);
+
+	if (i == _rows.end())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"feature matrix does not contain tube " << id);
+
+	return i->second;
+}
+
+void
+FeatureMatrix::copyTo(Features& features) const {
+
+	// rows are not sorted by id, insert all at once
+	std::vector<std::pair<TubeId, std::vector<double>>> rows;
+	rows.reserve(numTubes());
+	for (std::size_t i = 0; i < numTubes(); i++)
+		rows.push_back(std::make_pair(_ids[i], std::vector<double>(row(i), row(i) + _numFeatures)));
+
+	features.insert(std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+}
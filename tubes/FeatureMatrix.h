@@ -0,0 +1,87 @@
+#ifndef HOST_TUBES_FEATURE_MATRIX_H__
+#define HOST_TUBES_FEATURE_MATRIX_H__
+
+#include <vector>
+#include <unordered_map>
+#include "Features.h"
+
+/**
+ * Dense storage of the features of many tubes, one row of numFeatures() 
+ * values per tube, stored contiguously in row-major order.
+ */
+class FeatureMatrix {
+
+public:
+
+	/**
+	 * Create an empty feature matrix for the given number of features per 
+	 * tube.
+	 */
+	explicit FeatureMatrix(std::size_t numFeatures = 0) :
+		_numFeatures(numFeatures) {}
+
+	/**
+	 * Create a feature matrix from a feature map. All feature vectors have to 
+	 * have the same size.
+	 */
+	explicit FeatureMatrix(const Features& features);
+
+	/**
+	 * Reserve memory for the given number of tubes.
+	 */
+	void reserve(std::size_t numTubes);
+
+	/**
+	 * Append a row of zeros for the given tube. Returns the index of the row. 
+	 * If the tube has a row already, its index is returned.
+	 */
+	std::size_t addTube(TubeId id);
+
+	std::size_t numTubes() const { return _ids.size(); }
+
+	std::size_t numFeatures() const { return _numFeatures; }
+
+	/**
+	 * The tube ids of the rows.
+	 */
+	const std::vector<TubeId>& getIds() const { return _ids; }
+
+	bool contains(TubeId id) const { return _rows.count(id); }
+
+	/**
+	 * The index of the row of the given tube.
+	 */
+	std::size_t getRow(TubeId id) const;
+
+	/**
+	 * Direct access to the features of a row.
+	 */
+	double*       row(std::size_t i)       { return _data.data() + i*_numFeatures; }
+	const double* row(std::size_t i) const { return _data.data() + i*_numFeatures; }
+
+	double& operator()(std::size_t row, std::size_t feature)       { return _data[row*_numFeatures + feature]; }
+	double  operator()(std::size_t row, std::size_t feature) const { return _data[row*_numFeatures + feature]; }
+
+	/**
+	 * All features, row by row.
+	 */
+	std::vector<double>&       data()       { return _data; }
+	const std::vector<double>& data() const { return _data; }
+
+	/**
+	 * Add the rows of this matrix to a feature map.
+	 */
+	void copyTo(Features& features) const;
+
+private:
+
+	std::size_t _numFeatures;
+
+	std::vector<TubeId> _ids;
+	std::vector<double> _data;
+
+	// the row of each tube id
+	std::unordered_map<TubeId, std::size_t> _rows;
+};
+
+#endif // HOST_TUBES_FEATURE_MATRIX_H__
@@ -2,10 +2,14 @@
 #define HOST_FEATURES_FEATURES_H__
 
 #include <vector>
+#include <iterator>
 #include "TubePropertyMap.h"
 #include "TubeIds.h"
 
-class Features : public TubePropertyMap<std::vector<double>> {
+/**
+ * Feature vectors of tubes, sorted by id for fast iteration.
+ */
+class Features : public TubePropertyMap<std::vector<double>, SortedStorage> {
 
 public:
 
@@ -20,8 +24,17 @@ public:
 	 */
 	Features(const TubeIds& ids, std::size_t numFeatures) {
 
-		for (auto id : ids)
-			(*this)[id].reserve(numFeatures);
+		std::vector<std::pair<TubeId, std::vector<double>>> features(ids.size());
+
+		std::size_t i = 0;
+		for (auto id : ids) {
+
+			features[i].first = id;
+			features[i].second.reserve(numFeatures);
+			i++;
+		}
+
+		insert(std::make_move_iterator(features.begin()), std::make_move_iterator(features.end()));
 	}
 
 	/**
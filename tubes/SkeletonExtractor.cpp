@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <util/Logger.h>
 #include <util/ProgramOptions.h>
 #include "SkeletonExtractor.h"
@@ -9,77 +11,291 @@
 #include <vigra/multi_watersheds.hxx>
 #include <vigra/functorexpression.hxx>
 #include <util/timing.h>
+#include <volumes/ParallelFor.h>
+#include <tubes/io/ConcurrentTubeStore.h>
+#include "TubeIdSet.h"
 
 logger::LogChannel skeletonextractorlog("skeletonextractorlog", "[SkeletonExtractor] ");
 
+namespace {
+
+// log channels are not synchronized, the worker threads and the writer thread 
+// hold this mutex while they log
+std::mutex logMutex;
+
+} // anonymous namespace
+
 util::ProgramOption optionSkeletonDownsampleVolume(
 		util::_long_name        = "skeletonDownsampleVolume",
 		util::_description_text = "downsample the volume dimensions by the largest power of two that does not change connectivity.");
 
+util::ProgramOption optionSkeletonSaveBatchSize(
+		util::_long_name        = "skeletonSaveBatchSize",
+		util::_description_text = "The number of skeletons to collect before they are written to the tube store.",
+		util::_default_value    = 100);
+
+util::ProgramOption optionSkeletonFlushInterval(
+		util::_long_name        = "skeletonFlushInterval",
+		util::_description_text = "The maximal time in seconds between two flushes of the tube store while skeletons are extracted.",
+		util::_default_value    = 60);
+
+util::ProgramOption optionSkeletonRecompute(
+		util::_long_name        = "skeletonRecompute",
+		util::_description_text = "Extract skeletons also for tubes that already have one in the tube store. The previous skeletons "
+		                          "are not removed from the project file, which grows by their size.");
+
 void
 SkeletonExtractor::extract() {
 
 	bool downsample = optionSkeletonDownsampleVolume;
 
-	TubeIds ids = _store->getTubeIds();
+	// the worker threads and the writer share the store through a single I/O 
+	// thread
+	ConcurrentTubeStore store(_store);
 
-	Volumes volumes;
-	_store->retrieveVolumes(ids, volumes);
+	TubeIds ids = store.getTubeIds();
 
-	Skeletons    skeletons;
-	GraphVolumes graphVolumes;
+	// resume an interrupted extraction
+	if (!optionSkeletonRecompute) {
 
-	for (TubeId id : ids) {
+		std::size_t numTubes = ids.size();
 
-		LOG_DEBUG(skeletonextractorlog)
-				<< "processing tube " << id << std::endl;
+		TubeIdSet remaining = TubeIdSet(ids) - TubeIdSet(store.getSkeletonizedTubeIds());
+		ids = remaining.asTubeIds();
 
-		try {
+		if (ids.size() < numTubes)
+			LOG_USER(skeletonextractorlog)
+					<< "skipping " << (numTubes - ids.size())
+					<< " tubes that already have a skeleton" << std::endl;
 
-			Timer t("skeletonize volume");
+	} else {
 
-			ExplicitVolume<float> downsampled;
+		std::size_t numReplaced = store.getSkeletonizedTubeIds().size();
 
-			if (downsample)
-				downsampled = downsampleVolume(volumes[id]);
-			else
-				downsampled = volumes[id];
+		if (numReplaced > 0)
+			LOG_USER(skeletonextractorlog)
+					<< "recomputing " << numReplaced << " skeletons, the previous ones "
+					<< "stay in the project file" << std::endl;
+	}
 
-			LOG_DEBUG(skeletonextractorlog)
-					<< "original volume has discrete bb " << volumes[id].getDiscreteBoundingBox()
-					<< ", offset " << volumes[id].getOffset() << ", and resolution " << volumes[id].getResolution()
-					<< std::endl;
+	// skeletonize the largest tubes first, such that a few giant tubes don't 
+	// keep a single thread busy after all others are done
+	VolumeSizes sizes;
+	store.retrieveVolumeSizes(ids, sizes);
 
-			LOG_DEBUG(skeletonextractorlog)
-					<< "downsampled volume has discrete bb " << downsampled.getDiscreteBoundingBox()
-					<< ", offset " << downsampled.getOffset() << ", and resolution " << downsampled.getResolution()
-					<< std::endl;
+	std::vector<TubeId> order(ids.begin(), ids.end());
+	std::stable_sort(
+			order.begin(),
+			order.end(),
+			[&sizes](TubeId a, TubeId b) { return sizes[a] > sizes[b]; });
 
-			GraphVolume graph(downsampled);
+	LOG_USER(skeletonextractorlog)
+			<< "skeletonizing " << order.size() << " tubes on "
+			<< getNumThreads() << " threads" << std::endl;
 
-			LOG_DEBUG(skeletonextractorlog)
-					<< "graph volume has discrete bb " << graph.getDiscreteBoundingBox()
-					<< ", offset " << graph.getOffset() << ", and resolution " << graph.getResolution()
-					<< std::endl;
+	Writer writer(
+			store,
+			optionSkeletonSaveBatchSize.as<std::size_t>(),
+			optionSkeletonFlushInterval.as<double>());
 
-			Skeletonize skeletonize(graph);
+	// tubes that could not be skeletonized, reported after all workers are 
+	// done
+	std::vector<TubeId> noNodeFound;
+	std::mutex          noNodeFoundMutex;
 
-			skeletons.insert(id, skeletonize.getSkeleton());
-			graphVolumes.insert(id, std::move(graph));
+	{
+		Timer t("skeletonize volumes");
 
-		} catch (NoNodeFound& e) {
+		parallelFor(0, order.size(), [&](std::size_t i) {
 
-			LOG_USER(skeletonextractorlog)
-					<< "tube " << id
-					<< " could not be skeletonized (NoNodeFound)"
-					<< std::endl;
-		}
+			TubeId id = order[i];
+
+			// load one volume at a time, such that only the volumes currently 
+			// processed are kept in memory
+			TubeIds tubeId;
+			tubeId.add(id);
+			Volumes volumes;
+			store.retrieveVolumes(tubeId, volumes);
+
+			const ExplicitVolume<unsigned char>& volume = volumes[id];
+
+			try {
+
+				ExplicitVolume<float> downsampled;
+
+				if (downsample)
+					downsampled = downsampleVolume(volume);
+				else
+					downsampled = volume;
+
+				GraphVolume graph(downsampled);
+
+				{
+					std::lock_guard<std::mutex> lock(logMutex);
+
+					LOG_DEBUG(skeletonextractorlog)
+							<< "tube " << id << ": original volume has discrete bb " << volume.getDiscreteBoundingBox()
+							<< ", offset " << volume.getOffset() << ", and resolution " << volume.getResolution()
+							<< "; downsampled volume has discrete bb " << downsampled.getDiscreteBoundingBox()
+							<< ", offset " << downsampled.getOffset() << ", and resolution " << downsampled.getResolution()
+							<< "; graph volume has discrete bb " << graph.getDiscreteBoundingBox()
+							<< ", offset " << graph.getOffset() << ", and resolution " << graph.getResolution()
+							<< std::endl;
+				}
+
+				Skeletonize skeletonize(graph);
+
+				writer.add(id, skeletonize.getSkeleton(), std::move(graph));
+
+			} catch (NoNodeFound& e) {
+
+				std::lock_guard<std::mutex> lock(noNodeFoundMutex);
+				noNodeFound.push_back(id);
+			}
+		});
+	}
+
+	writer.finish();
+
+	std::sort(noNodeFound.begin(), noNodeFound.end());
+	for (TubeId id : noNodeFound)
+		LOG_USER(skeletonextractorlog)
+				<< "tube " << id
+				<< " could not be skeletonized (NoNodeFound)"
+				<< std::endl;
+}
+
+SkeletonExtractor::Writer::Writer(TubeStore& store, std::size_t batchSize, double flushInterval) :
+	_store(store),
+	_batchSize(std::max<std::size_t>(batchSize, 1)),
+	_flushInterval(flushInterval),
+	_done(false),
+	_cancelled(false),
+	_thread(&SkeletonExtractor::Writer::write, this) {}
+
+SkeletonExtractor::Writer::~Writer() {
+
+	if (!_thread.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_done      = true;
+		_cancelled = true;
+	}
+
+	_batchReady.notify_one();
+	_thread.join();
+}
+
+void
+SkeletonExtractor::Writer::add(TubeId id, Skeleton&& skeleton, GraphVolume&& graphVolume) {
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// don't let results pile up if the writer can't keep up
+	_spaceAvailable.wait(lock, [this]() {
+		return _graphVolumes.size() < 2*_batchSize || _error;
+	});
+
+	if (_error)
+		std::rethrow_exception(_error);
+
+	_skeletons.insert(id, std::move(skeleton));
+	_graphVolumes.insert(id, std::move(graphVolume));
+
+	if (_graphVolumes.size() >= _batchSize)
+		_batchReady.notify_one();
+}
+
+void
+SkeletonExtractor::Writer::finish() {
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_done = true;
 	}
 
-	_store->saveSkeletons(skeletons);
-	_store->saveGraphVolumes(graphVolumes);
+	_batchReady.notify_one();
+	_thread.join();
+
+	if (_error)
+		std::rethrow_exception(_error);
 }
 
+void
+SkeletonExtractor::Writer::write() {
+
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point lastFlush = Clock::now();
+
+	while (true) {
+
+		Skeletons    skeletons;
+		GraphVolumes graphVolumes;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+
+			_batchReady.wait(lock, [this]() {
+				return _done || _graphVolumes.size() >= _batchSize;
+			});
+
+			if (_cancelled)
+				return;
+
+			for (auto& p : _skeletons)
+				skeletons.insert(p.first, std::move(p.second));
+			for (auto& p : _graphVolumes)
+				graphVolumes.insert(p.first, std::move(p.second));
+
+			_skeletons.clear();
+			_graphVolumes.clear();
+		}
+
+		_spaceAvailable.notify_all();
+
+		bool last = (graphVolumes.size() < _batchSize);
+
+		try {
+
+			if (graphVolumes.size() > 0) {
+
+				{
+					std::lock_guard<std::mutex> lock(logMutex);
+					LOG_DEBUG(skeletonextractorlog)
+							<< "saving " << graphVolumes.size() << " skeletons" << std::endl;
+				}
+
+				// skeletons first, the graph volumes mark a tube as complete
+				_store.saveSkeletons(skeletons);
+				_store.saveGraphVolumes(graphVolumes);
+			}
+
+			double sinceFlush = std::chrono::duration<double>(Clock::now() - lastFlush).count();
+
+			if (last || sinceFlush >= _flushInterval) {
+
+				_store.flush();
+				lastFlush = Clock::now();
+			}
+
+			if (last)
+				return;
+
+		} catch (...) {
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_error = std::current_exception();
+			}
+
+			_spaceAvailable.notify_all();
+			return;
+		}
+	}
+}
 
 ExplicitVolume<float>
 SkeletonExtractor::downsampleVolume(const ExplicitVolume<unsigned char>& volume) {
@@ -104,22 +320,13 @@ SkeletonExtractor::downsampleVolume(const ExplicitVolume<unsigned char>& volume)
 			finestDimension = d;
 		}
 
-	// the largest downsample factor to consider
-	int downsampleFactor = 8;
+	// the pyramid of downsample factors to consider, coarsest first
+	std::vector<vigra::TinyVector<int, 3>> levels;
 
-	while (true) {
+	for (int downsampleFactor = 8; downsampleFactor > 1; downsampleFactor /= 2) {
 
-		LOG_DEBUG(skeletonextractorlog)
-				<< "trying to downsample finest dimension by factor "
-				<< downsampleFactor << std::endl;
-
-		vigra::TinyVector<int, 3>   factors;
-		vigra::TinyVector<float, 3> targetRes;
-		vigra::TinyVector<int, 3>   targetSize;
-
-		factors[finestDimension]    = downsampleFactor;
-		targetRes[finestDimension]  = origRes[finestDimension]*downsampleFactor;
-		targetSize[finestDimension] = origSize[finestDimension]/downsampleFactor;
+		vigra::TinyVector<int, 3> factors;
+		factors[finestDimension] = downsampleFactor;
 
 		// the target resolution of the finest dimension, when downsampled with 
 		// current factor
@@ -146,53 +353,117 @@ SkeletonExtractor::downsampleVolume(const ExplicitVolume<unsigned char>& volume)
 				}
 			}
 
-			factors[d]    = bestFactor;
-			targetRes[d]  = origRes[d]*bestFactor;
-			targetSize[d] = origSize[d]/bestFactor;
+			factors[d] = bestFactor;
 		}
 
-		LOG_DEBUG(skeletonextractorlog)
-				<< "best downsampling factors for each dimension are "
-				<< factors << std::endl;
+		levels.push_back(factors);
+	}
+
+	// reused for each level
+	std::vector<int> parents;
+
+	for (const vigra::TinyVector<int, 3>& factors : levels) {
+
+		vigra::TinyVector<int, 3> targetSize = origSize/factors;
+
+		bool singleComponent = isSingleComponent(volume, factors, targetSize, parents);
+
+		{
+			std::lock_guard<std::mutex> lock(logMutex);
 
+			LOG_DEBUG(skeletonextractorlog)
+					<< "downsampling finest dimension by factor "
+					<< factors[finestDimension]
+					<< " (factors per dimension " << factors << ") "
+					<< (singleComponent ? "keeps" : "does not keep")
+					<< " a single connected component"
+					<< std::endl;
+		}
+
+		if (!singleComponent)
+			continue;
+
+		// only the accepted level is materialized
 		ExplicitVolume<unsigned char> downsampled(targetSize[0], targetSize[1], targetSize[2]);
-		downsampled.setResolution(targetRes[0], targetRes[1], targetRes[2]);
+		downsampled.setResolution(
+				origRes[0]*factors[0],
+				origRes[1]*factors[1],
+				origRes[2]*factors[2]);
 		downsampled.setOffset(volume.getOffset());
 
-		// copy volume
 		for (int z = 0; z < targetSize[2]; z++)
 		for (int y = 0; y < targetSize[1]; y++)
 		for (int x = 0; x < targetSize[0]; x++)
 			downsampled(x, y, z) = volume(x*factors[0], y*factors[1], z*factors[2]);
 
-		int numRegions;
-		try {
+		return downsampled;
+	}
 
-			// check for downsampling errors
-			vigra::MultiArray<3, unsigned int> labels(downsampled.data().shape());
-			numRegions = vigra::labelMultiArrayWithBackground(
-					downsampled.data(),
-					labels);
+	return volume;
+}
 
-		} catch (vigra::InvariantViolation& e) {
+bool
+SkeletonExtractor::isSingleComponent(
+		const ExplicitVolume<unsigned char>& volume,
+		const vigra::TinyVector<int, 3>&     factors,
+		const vigra::TinyVector<int, 3>&     size,
+		std::vector<int>&                    parents) {
 
-			LOG_DEBUG(skeletonextractorlog)
-					<< "downsampled image contains more than 255 connected components"
-					<< std::endl;
+	const int strideY = size[0];
+	const int strideZ = size[0]*size[1];
+
+	// -1 for background samples
+	parents.assign(static_cast<std::size_t>(size[0])*size[1]*size[2], -1);
 
-			numRegions = 2;
+	auto find = [&parents](int i) {
+
+		while (parents[i] != i) {
+
+			parents[i] = parents[parents[i]];
+			i = parents[i];
 		}
 
-		LOG_DEBUG(skeletonextractorlog)
-				<< "downsampled image contains " << numRegions
-				<< " connected components" << std::endl;
+		return i;
+	};
+
+	// merge the components of i and j, returns 1 if they were different
+	auto merge = [&parents, &find](int i, int j) {
+
+		i = find(i);
+		j = find(j);
+
+		if (i == j)
+			return 0;
+
+		if (i < j)
+			parents[j] = i;
+		else
+			parents[i] = j;
+
+		return 1;
+	};
+
+	int numComponents = 0;
+	int i = 0;
+
+	for (int z = 0; z < size[2]; z++)
+	for (int y = 0; y < size[1]; y++)
+	for (int x = 0; x < size[0]; x++, i++) {
+
+		if (!volume(x*factors[0], y*factors[1], z*factors[2]))
+			continue;
 
-		if (numRegions == 1)
-			return downsampled;
+		parents[i] = i;
+		numComponents++;
 
-		downsampleFactor /= 2;
-		if (downsampleFactor == 1)
-			return volume;
+		// 6-neighborhood, as in labelMultiArrayWithBackground
+		if (x > 0 && parents[i - 1] >= 0)
+			numComponents -= merge(i, i - 1);
+		if (y > 0 && parents[i - strideY] >= 0)
+			numComponents -= merge(i, i - strideY);
+		if (z > 0 && parents[i - strideZ] >= 0)
+			numComponents -= merge(i, i - strideZ);
 	}
 
+	return numComponents == 1;
 }
@@ -1,6 +1,11 @@
 #ifndef HOST_TUBES_SKELETON_EXTRACTOR_H__
 #define HOST_TUBES_SKELETON_EXTRACTOR_H__
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <vector>
 #include <tubes/io/TubeStore.h>
 #include <imageprocessing/ExplicitVolume.h>
 #include <imageprocessing/Skeletonize.h>
@@ -14,16 +19,85 @@ public:
 
 	/**
 	 * Extract the skeletons for all tubes in the given store, and store them in 
-	 * the same store.
+	 * the same store. Tubes are skeletonized in parallel, largest first. 
+	 * Results are saved while the extraction is running, and tubes that 
+	 * already have a skeleton in the store are skipped, such that an 
+	 * interrupted extraction can be resumed.
 	 */
 	void extract();
 
 private:
 
+	/**
+	 * Collects skeletons and graph volumes from several threads and saves them 
+	 * in batches on a separate writer thread. The store is flushed at least 
+	 * every flushInterval seconds.
+	 */
+	class Writer {
+
+	public:
+
+		Writer(TubeStore& store, std::size_t batchSize, double flushInterval);
+
+		/**
+		 * Stops the writer thread without saving pending results, if finish() 
+		 * was not called.
+		 */
+		~Writer();
+
+		/**
+		 * Queue the results for one tube. Blocks while the writer thread is 
+		 * behind by more than two batches.
+		 */
+		void add(TubeId id, Skeleton&& skeleton, GraphVolume&& graphVolume);
+
+		/**
+		 * Save all pending results, flush the store, and stop the writer thread. 
+		 * Rethrows any exception that occurred while saving.
+		 */
+		void finish();
+
+	private:
+
+		// the main loop of the writer thread
+		void write();
+
+		TubeStore&  _store;
+		std::size_t _batchSize;
+		double      _flushInterval;
+
+		Skeletons    _skeletons;
+		GraphVolumes _graphVolumes;
+
+		std::mutex              _mutex;
+		std::condition_variable _batchReady;
+		std::condition_variable _spaceAvailable;
+		bool                    _done;
+		bool                    _cancelled;
+		std::exception_ptr      _error;
+
+		std::thread _thread;
+	};
+
+	/**
+	 * Subsample the volume by the largest power of two (up to 8) that keeps 
+	 * the tube a single connected component.
+	 */
 	ExplicitVolume<float> downsampleVolume(const ExplicitVolume<unsigned char>& volume);
 
+	/**
+	 * Check whether the foreground of the volume, subsampled by the given 
+	 * factors to the given size, is a single 6-connected component. Uses 
+	 * union-find in a single pass over the samples, without creating the 
+	 * subsampled volume. parents is used as buffer.
+	 */
+	static bool isSingleComponent(
+			const ExplicitVolume<unsigned char>& volume,
+			const vigra::TinyVector<int, 3>&     factors,
+			const vigra::TinyVector<int, 3>&     size,
+			std::vector<int>&                    parents);
+
 	TubeStore*  _store;
 };
 
 #endif // HOST_TUBES_SKELETON_EXTRACTOR_H__
-
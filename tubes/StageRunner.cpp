@@ -0,0 +1,133 @@
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include "StageRunner.h"
+
+logger::LogChannel stagerunnerlog("stagerunnerlog", "[StageRunner] ");
+
+void
+StageRunner::addStage(
+		const std::string&              name,
+		const std::vector<std::string>& dependencies,
+		std::function<bool()>           isCurrent,
+		std::function<void()>           run) {
+
+	Stage stage;
+	stage.name      = name;
+	stage.isCurrent = isCurrent;
+	stage.run       = run;
+
+	// dependencies have to be added before, such that there are no cycles
+	for (const std::string& dependency : dependencies) {
+
+		int i = 0;
+		while (i < static_cast<int>(_stages.size()) && _stages[i].name != dependency)
+			i++;
+
+		if (i == static_cast<int>(_stages.size()))
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"stage " << name << " depends on unknown stage " << dependency);
+
+		stage.dependencies.push_back(i);
+	}
+
+	_stages.push_back(stage);
+}
+
+void
+StageRunner::run() {
+
+	enum State { Waiting, Running, Skipped, Done };
+
+	std::vector<State>       states(_stages.size(), Waiting);
+	std::vector<std::thread> threads;
+	std::exception_ptr       error;
+	std::mutex               mutex;
+	std::condition_variable  finished;
+
+	auto execute = [&](int i, bool inputsChanged) {
+
+		Stage& stage = _stages[i];
+		State  state = Done;
+
+		try {
+
+			if (!inputsChanged && stage.isCurrent()) {
+
+				LOG_USER(stagerunnerlog) << stage.name << " is up to date" << std::endl;
+				state = Skipped;
+
+			} else {
+
+				LOG_USER(stagerunnerlog) << "running " << stage.name << "..." << std::endl;
+				stage.run();
+				LOG_USER(stagerunnerlog) << stage.name << " done" << std::endl;
+			}
+
+		} catch (...) {
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!error)
+				error = std::current_exception();
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			states[i] = state;
+		}
+
+		finished.notify_one();
+	};
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while (true) {
+
+			int numRunning = 0;
+
+			for (std::size_t i = 0; i < _stages.size(); i++) {
+
+				if (states[i] == Running)
+					numRunning++;
+
+				if (states[i] != Waiting || error)
+					continue;
+
+				bool ready         = true;
+				bool inputsChanged = false;
+				for (int dependency : _stages[i].dependencies) {
+
+					if (states[dependency] == Waiting || states[dependency] == Running)
+						ready = false;
+					if (states[dependency] == Done)
+						inputsChanged = true;
+				}
+
+				if (!ready)
+					continue;
+
+				states[i] = Running;
+				numRunning++;
+				threads.push_back(std::thread(execute, i, inputsChanged));
+			}
+
+			// either all stages are finished, or there was an error and the
+			// running ones are finished
+			if (numRunning == 0)
+				break;
+
+			finished.wait(lock);
+		}
+	}
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
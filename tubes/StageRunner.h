@@ -0,0 +1,52 @@
+#ifndef HOST_TUBES_STAGE_RUNNER_H__
+#define HOST_TUBES_STAGE_RUNNER_H__
+
+#include <string>
+#include <vector>
+#include <functional>
+
+/**
+ * Runs the stages of a processing pipeline in the order given by their
+ * dependencies. Stages whose dependencies are done are started on their own
+ * threads, such that independent stages run concurrently.
+ *
+ * A stage is skipped if its outputs are current already, unless one of its
+ * dependencies was run (in which case its inputs might have changed).
+ */
+class StageRunner {
+
+public:
+
+	/**
+	 * Add a stage. Dependencies are given by the names of stages that have
+	 * been added before. isCurrent is called right before the stage would be
+	 * run, to check whether its outputs exist already.
+	 */
+	void addStage(
+			const std::string&              name,
+			const std::vector<std::string>& dependencies,
+			std::function<bool()>           isCurrent,
+			std::function<void()>           run);
+
+	/**
+	 * Run all stages. The first exception thrown by a stage prevents further
+	 * stages from being started. It is rethrown after the running stages
+	 * finished.
+	 */
+	void run();
+
+private:
+
+	struct Stage {
+
+		std::string           name;
+		std::vector<int>      dependencies;
+		std::function<bool()> isCurrent;
+		std::function<void()> run;
+	};
+
+	std::vector<Stage> _stages;
+};
+
+#endif // HOST_TUBES_STAGE_RUNNER_H__
+
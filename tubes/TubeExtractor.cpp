@@ -1,53 +1,207 @@
+#include <unordered_map>
+#include <limits>
 #include <vigra/functorexpression.hxx>
+#include <util/Logger.h>
+#include <util/timing.h>
+#include <volumes/ParallelFor.h>
 #include "TubeExtractor.h"
 
+logger::LogChannel tubeextractorlog("tubeextractorlog", "[TubeExtractor] ");
+
 void
-TubeExtractor::extractFrom(ExplicitVolume<int>& labels, const std::set<TubeId>& ids) {
+TubeExtractor::extractFrom(ExplicitVolume<int>& labels, const TubeIdSet& ids) {
 
-	std::map<TubeId, util::box<float,3>> bbs;
+	std::map<TubeId, DiscreteBox> bbs;
+	findBoundingBoxes(labels, bbs);
 
-	// get the discrete bounding boxes of all tubes
-	for (unsigned int z = 0; z < labels.depth();  z++)
-	for (unsigned int y = 0; y < labels.height(); y++)
-	for (unsigned int x = 0; x < labels.width();  x++) {
+	// the tubes to extract
+	std::vector<std::pair<TubeId, DiscreteBox>> tubes;
+	for (auto& p : bbs)
+		if (ids.empty() || ids.contains(p.first))
+			tubes.push_back(p);
 
-		TubeId id = labels(x, y, z);
+	// create the volumes up-front, such that the threads below don't modify 
+	// the map
+	Volumes volumes;
+	std::vector<ExplicitVolume<unsigned char>*> tubeVolumes;
+	for (auto& p : tubes)
+		tubeVolumes.push_back(&volumes[p.first]);
 
-		if (id == 0)
-			continue;
+	LOG_USER(tubeextractorlog) << "extracting " << tubes.size() << " tubes" << std::endl;
+
+	{
+		Timer t("extract tube volumes");
+
+		// extract the tube volumes
+		parallelFor(0, tubes.size(), [&](std::size_t i) {
 
-		bbs[id] += util::box<float,3>(x, y, z, x+1, y+1, z+1);
+			extractTube(labels, tubes[i].first, tubes[i].second, *tubeVolumes[i]);
+		});
 	}
 
-	// extract the tube volumes
-	Volumes volumes;
+	// save them
+	_store->saveVolumes(volumes);
+}
+
+void
+TubeExtractor::extractFrom(VolumeStore& volumeStore, const vigra::Shape3& blockShape, const TubeIdSet& ids) {
+
+	vigra::Shape3 shape = volumeStore.getLabelsShape();
+
+	LOG_USER(tubeextractorlog)
+			<< "scanning label volume of size " << shape
+			<< " in blocks of " << blockShape << std::endl;
+
+	// accumulate the bounding boxes over all blocks
+
+	std::map<TubeId, DiscreteBox> bbs;
+
+	ExplicitVolume<int> block;
+
+	for (int z = 0; z < shape[2]; z += blockShape[2])
+	for (int y = 0; y < shape[1]; y += blockShape[1])
+	for (int x = 0; x < shape[0]; x += blockShape[0]) {
+
+		vigra::Shape3 begin(x, y, z);
+		vigra::Shape3 end = vigra::min(begin + blockShape, shape);
+
+		volumeStore.retrieveLabels(begin, end, block);
+
+		std::map<TubeId, DiscreteBox> blockBbs;
+		findBoundingBoxes(block, blockBbs);
+
+		for (auto& p : blockBbs) {
+
+			DiscreteBox& bb = p.second;
+
+			for (int d = 0; d < 3; d++) {
+
+				bb.min[d] += begin[d];
+				bb.max[d] += begin[d];
+			}
+
+			bbs[p.first].fit(bb);
+		}
+	}
+
+	// read the labels of each tube's bounding box, and store the tube right 
+	// away, such that we never hold more than one tube in memory
+
+	unsigned int numTubes = 0;
 
 	for (auto& p : bbs) {
 
-		TubeId              id = p.first;
-		util::box<float,3>& bb = p.second;
-
-		if (!ids.empty())
-			if (!ids.count(id))
-				continue;
-
-		// set volume properties
-		volumes[id].setResolution(
-				labels.getResolutionX(),
-				labels.getResolutionY(),
-				labels.getResolutionZ());
-		volumes[id].setOffset(labels.getOffset() + bb.min()*labels.getResolution());
-		volumes[id].data() = vigra::MultiArray<3, char>(vigra::Shape3(bb.width(), bb.height(), bb.depth()));
-
-		// copy data
-		vigra::transformMultiArray(
-				labels.data().subarray(
-						vigra::Shape3(bb.min().x(), bb.min().y(), bb.min().z()),
-						vigra::Shape3(bb.max().x(), bb.max().y(), bb.max().z())),
-				volumes[id].data(),
-				(vigra::functor::Arg1() == vigra::functor::Param(id)));
+		TubeId             id = p.first;
+		const DiscreteBox& bb = p.second;
+
+		if (!ids.empty() && !ids.contains(id))
+			continue;
+
+		vigra::Shape3 begin(bb.min[0], bb.min[1], bb.min[2]);
+		vigra::Shape3 end(bb.max[0], bb.max[1], bb.max[2]);
+
+		volumeStore.retrieveLabels(begin, end, block);
+
+		Volumes volumes;
+		extractTube(block, id, DiscreteBox(end - begin), volumes[id]);
+
+		_store->saveVolumes(volumes);
+		numTubes++;
 	}
 
-	// save them
-	_store->saveVolumes(volumes);
+	LOG_USER(tubeextractorlog) << "extracted " << numTubes << " tubes" << std::endl;
+}
+
+void
+TubeExtractor::extractTube(
+		const ExplicitVolume<int>&     labels,
+		TubeId                         id,
+		const DiscreteBox&             bb,
+		ExplicitVolume<unsigned char>& volume) {
+
+	vigra::Shape3 begin(bb.min[0], bb.min[1], bb.min[2]);
+	vigra::Shape3 end(bb.max[0], bb.max[1], bb.max[2]);
+
+	// set volume properties
+	volume.setResolution(
+			labels.getResolutionX(),
+			labels.getResolutionY(),
+			labels.getResolutionZ());
+	volume.setOffset(
+			labels.getOffset() +
+			util::point<float,3>(bb.min[0], bb.min[1], bb.min[2])*labels.getResolution());
+	volume.data() = vigra::MultiArray<3, unsigned char>(end - begin);
+
+	// copy data
+	vigra::transformMultiArray(
+			labels.data().subarray(begin, end),
+			volume.data(),
+			(vigra::functor::Arg1() == vigra::functor::Param(id)));
+}
+
+void
+TubeExtractor::findBoundingBoxes(const ExplicitVolume<int>& labels, std::map<TubeId, DiscreteBox>& bbs) {
+
+	UTIL_TIME_METHOD;
+
+	typedef std::unordered_map<TubeId, DiscreteBox> SlabBoxes;
+
+	const int width  = labels.width();
+	const int height = labels.height();
+	const int depth  = labels.depth();
+
+	// a few slabs per thread to balance the load between slabs with different 
+	// amounts of foreground
+	std::size_t numSlabs = std::min<std::size_t>(depth, 4*getNumThreads());
+
+	std::vector<SlabBoxes> slabBoxes(numSlabs);
+
+	parallelFor(0, numSlabs, [&](std::size_t s) {
+
+		const int zBegin = s*depth/numSlabs;
+		const int zEnd   = (s + 1)*depth/numSlabs;
+
+		SlabBoxes& boxes = slabBoxes[s];
+
+		// most runs belong to the same tube as the previous one, remember it 
+		// to save the hash lookup
+		TubeId       lastId = 0;
+		DiscreteBox* lastBb = 0;
+
+		for (int z = zBegin; z < zEnd; z++)
+		for (int y = 0; y < height; y++) {
+
+			const int* row = &labels.data()(0, y, z);
+
+			int x = 0;
+			while (x < width) {
+
+				// find the end of the run of the current label
+				TubeId id  = row[x];
+				int    end = x + 1;
+				while (end < width && row[end] == id)
+					end++;
+
+				if (id != 0) {
+
+					if (id != lastId || lastBb == 0) {
+
+						lastId = id;
+						lastBb = &boxes[id];
+					}
+
+					lastBb->fit(x, end, y, z);
+				}
+
+				x = end;
+			}
+		}
+	});
+
+	// merge the slabs
+	for (const SlabBoxes& boxes : slabBoxes)
+		for (const auto& p : boxes)
+			bbs[p.first].fit(p.second);
+
+	LOG_DEBUG(tubeextractorlog) << "found " << bbs.size() << " tubes" << std::endl;
 }
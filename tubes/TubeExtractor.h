@@ -1,8 +1,13 @@
 #ifndef HOST_TUBES_TUBE_EXTRACTOR_H__
 #define HOST_TUBES_TUBE_EXTRACTOR_H__
 
+#include <map>
+#include <limits>
+#include <algorithm>
 #include <imageprocessing/ExplicitVolume.h>
+#include <volumes/io/VolumeStore.h>
 #include <tubes/io/TubeStore.h>
+#include <tubes/TubeIdSet.h>
 
 /**
  * Extracts tubes from a source like a label image and saves their volumes with 
@@ -17,12 +22,86 @@ public:
 
 	/**
 	 * Extract tubes from a label image. The values of the label image are 
-	 * interpreted as tube ids.
+	 * interpreted as tube ids. If ids is not empty, only the given tubes are 
+	 * extracted.
 	 */
-	void extractFrom(ExplicitVolume<int>& labels, const std::set<TubeId>& ids = std::set<TubeId>());
+	void extractFrom(ExplicitVolume<int>& labels, const TubeIdSet& ids = TubeIdSet());
+
+	/**
+	 * Extract tubes from the label volume of a volume store, without reading 
+	 * the whole label volume into memory. The labels are scanned in blocks of 
+	 * the given shape to find the bounding boxes of all tubes, then the 
+	 * bounding box of each tube is read separately. Tubes are stored one at a 
+	 * time.
+	 */
+	void extractFrom(
+			VolumeStore&         volumeStore,
+			const vigra::Shape3& blockShape,
+			const TubeIdSet&     ids = TubeIdSet());
 
 private:
 
+	/**
+	 * A discrete bounding box, cheaper to grow than util::box.
+	 */
+	struct DiscreteBox {
+
+		DiscreteBox() {
+
+			std::fill(min, min + 3, std::numeric_limits<int>::max());
+			std::fill(max, max + 3, std::numeric_limits<int>::min());
+		}
+
+		/**
+		 * A box from the origin to the given shape.
+		 */
+		explicit DiscreteBox(const vigra::Shape3& shape) {
+
+			for (int d = 0; d < 3; d++) {
+
+				min[d] = 0;
+				max[d] = shape[d];
+			}
+		}
+
+		/**
+		 * Grow to include the run of voxels [xBegin,xEnd) in row y of section 
+		 * z.
+		 */
+		void fit(int xBegin, int xEnd, int y, int z) {
+
+			min[0] = std::min(min[0], xBegin); max[0] = std::max(max[0], xEnd);
+			min[1] = std::min(min[1], y);      max[1] = std::max(max[1], y + 1);
+			min[2] = std::min(min[2], z);      max[2] = std::max(max[2], z + 1);
+		}
+
+		/**
+		 * Grow to include another box.
+		 */
+		void fit(const DiscreteBox& other) {
+
+			for (int d = 0; d < 3; d++) {
+
+				min[d] = std::min(min[d], other.min[d]);
+				max[d] = std::max(max[d], other.max[d]);
+			}
+		}
+
+		int min[3];
+		int max[3];
+	};
+
+	// extract the volume of a single tube within the given bounding box
+	void extractTube(
+			const ExplicitVolume<int>&     labels,
+			TubeId                         id,
+			const DiscreteBox&             bb,
+			ExplicitVolume<unsigned char>& volume);
+
+	// find the bounding boxes of all tubes in a single parallel pass over the 
+	// label volume
+	void findBoundingBoxes(const ExplicitVolume<int>& labels, std::map<TubeId, DiscreteBox>& bbs);
+
 	TubeStore* _store;
 };
 
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <util/exceptions.h>
+#include "TubeIdSet.h"
+
+TubeIdSet::TubeIdSet(const TubeIds& ids) :
+	_size(0) {
+
+	for (TubeId id : ids)
+		insert(id);
+}
+
+bool
+TubeIdSet::insert(TubeId id) {
+
+	if (id < 0)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"tube id sets can not store negative id " << id);
+
+	std::size_t c = chunk(id);
+
+	if (c >= _chunks.size())
+		_chunks.resize(c + 1);
+
+	Chunk& ch = _chunks[c];
+
+	if (ch.count == 0)
+		ch.words.assign(WordsPerChunk, 0);
+
+	std::uint64_t mask = std::uint64_t(1) << bit(id);
+	std::uint64_t& w   = ch.words[word(id)];
+
+	if (w & mask)
+		return false;
+
+	w |= mask;
+	ch.count++;
+	_size++;
+
+	return true;
+}
+
+bool
+TubeIdSet::remove(TubeId id) {
+
+	if (!contains(id))
+		return false;
+
+	Chunk& ch = _chunks[chunk(id)];
+
+	ch.words[word(id)] &= ~(std::uint64_t(1) << bit(id));
+	ch.count--;
+	_size--;
+
+	if (ch.count == 0)
+		std::vector<std::uint64_t>().swap(ch.words);
+
+	return true;
+}
+
+TubeIdSet&
+TubeIdSet::operator|=(const TubeIdSet& other) {
+
+	if (other._chunks.size() > _chunks.size())
+		_chunks.resize(other._chunks.size());
+
+	for (std::size_t c = 0; c < other._chunks.size(); c++) {
+
+		const Chunk& theirs = other._chunks[c];
+		Chunk&       ours   = _chunks[c];
+
+		if (theirs.count == 0)
+			continue;
+
+		if (ours.count == 0) {
+
+			ours = theirs;
+			continue;
+		}
+
+		for (std::size_t w = 0; w < WordsPerChunk; w++)
+			ours.words[w] |= theirs.words[w];
+
+		recount(ours);
+	}
+
+	updateSize();
+
+	return *this;
+}
+
+TubeIdSet&
+TubeIdSet::operator&=(const TubeIdSet& other) {
+
+	for (std::size_t c = 0; c < _chunks.size(); c++) {
+
+		Chunk& ours = _chunks[c];
+
+		if (ours.count == 0)
+			continue;
+
+		if (c >= other._chunks.size() || other._chunks[c].count == 0) {
+
+			ours = Chunk();
+			continue;
+		}
+
+		const Chunk& theirs = other._chunks[c];
+
+		for (std::size_t w = 0; w < WordsPerChunk; w++)
+			ours.words[w] &= theirs.words[w];
+
+		recount(ours);
+	}
+
+	updateSize();
+
+	return *this;
+}
+
+TubeIdSet&
+TubeIdSet::operator-=(const TubeIdSet& other) {
+
+	std::size_t numChunks = std::min(_chunks.size(), other._chunks.size());
+
+	for (std::size_t c = 0; c < numChunks; c++) {
+
+		Chunk&       ours   = _chunks[c];
+		const Chunk& theirs = other._chunks[c];
+
+		if (ours.count == 0 || theirs.count == 0)
+			continue;
+
+		for (std::size_t w = 0; w < WordsPerChunk; w++)
+			ours.words[w] &= ~theirs.words[w];
+
+		recount(ours);
+	}
+
+	updateSize();
+
+	return *this;
+}
+
+void
+TubeIdSet::clear() {
+
+	_chunks.clear();
+	_size = 0;
+}
+
+TubeIds
+TubeIdSet::asTubeIds() const {
+
+	TubeIds ids;
+	for (TubeId id : *this)
+		ids.add(id);
+
+	return ids;
+}
+
+void
+TubeIdSet::recount(Chunk& chunk) {
+
+	chunk.count = 0;
+	for (std::uint64_t w : chunk.words)
+		chunk.count += __builtin_popcountll(w);
+
+	if (chunk.count == 0)
+		std::vector<std::uint64_t>().swap(chunk.words);
+}
+
+void
+TubeIdSet::updateSize() {
+
+	_size = 0;
+	for (const Chunk& chunk : _chunks)
+		_size += chunk.count;
+}
+
+TubeIdSet::const_iterator::const_iterator(const TubeIdSet& set, std::size_t chunk) :
+	_set(&set),
+	_chunk(chunk),
+	_word(0),
+	_bits(0) {
+
+	const std::vector<Chunk>& chunks = _set->_chunks;
+
+	while (_chunk < chunks.size() && chunks[_chunk].count == 0)
+		_chunk++;
+
+	if (_chunk < chunks.size()) {
+
+		_bits = chunks[_chunk].words[0];
+		findNext();
+	}
+}
+
+TubeId
+TubeIdSet::const_iterator::operator*() const {
+
+	return static_cast<TubeId>(
+			(_chunk << ChunkBits) |
+			(_word << 6) |
+			__builtin_ctzll(_bits));
+}
+
+TubeIdSet::const_iterator&
+TubeIdSet::const_iterator::operator++() {
+
+	// clear the lowest set bit
+	_bits &= _bits - 1;
+	findNext();
+
+	return *this;
+}
+
+void
+TubeIdSet::const_iterator::findNext() {
+
+	const std::vector<Chunk>& chunks = _set->_chunks;
+
+	while (_bits == 0) {
+
+		if (++_word == WordsPerChunk) {
+
+			_word = 0;
+
+			do {
+				_chunk++;
+			} while (_chunk < chunks.size() && chunks[_chunk].count == 0);
+
+			if (_chunk >= chunks.size()) {
+
+				_chunk = chunks.size();
+				return;
+			}
+		}
+
+		_bits = chunks[_chunk].words[_word];
+	}
+}
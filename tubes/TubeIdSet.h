@@ -0,0 +1,141 @@
+#ifndef HOST_TUBES_TUBE_ID_SET_H__
+#define HOST_TUBES_TUBE_ID_SET_H__
+
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include "TubeId.h"
+#include "TubeIds.h"
+
+/**
+ * A set of non-negative tube ids, stored as a bitmap in chunks of 2^16 ids. 
+ * Chunks without any id don't use memory for their bits. Insertion, removal, 
+ * and membership tests take constant time, set operations work on 64 ids at 
+ * once. Iteration is in increasing order of ids.
+ */
+class TubeIdSet {
+
+	static const int         ChunkBits     = 16;
+	static const std::size_t WordsPerChunk = (std::size_t(1) << ChunkBits)/64;
+
+	struct Chunk {
+
+		Chunk() : count(0) {}
+
+		// number of ids in this chunk
+		std::size_t count;
+
+		// the bits, empty if count is 0
+		std::vector<std::uint64_t> words;
+	};
+
+public:
+
+	/**
+	 * Iterates over the ids of the set in increasing order.
+	 */
+	class const_iterator {
+
+	public:
+
+		typedef std::forward_iterator_tag iterator_category;
+		typedef TubeId                    value_type;
+		typedef std::ptrdiff_t            difference_type;
+		typedef const TubeId*             pointer;
+		typedef TubeId                    reference;
+
+		TubeId operator*() const;
+
+		const_iterator& operator++();
+
+		const_iterator operator++(int) { const_iterator i = *this; ++(*this); return i; }
+
+		bool operator==(const const_iterator& other) const { return _chunk == other._chunk && _word == other._word && _bits == other._bits; }
+		bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+	private:
+
+		friend class TubeIdSet;
+
+		const_iterator(const TubeIdSet& set, std::size_t chunk);
+
+		// advance to the next set bit, if _bits is 0
+		void findNext();
+
+		const TubeIdSet* _set;
+		std::size_t      _chunk;
+		std::size_t      _word;
+		std::uint64_t    _bits;
+	};
+
+	TubeIdSet() : _size(0) {}
+
+	/**
+	 * Create a set from a collection of tube ids.
+	 */
+	explicit TubeIdSet(const TubeIds& ids);
+
+	/**
+	 * Add an id. Returns true, if the id was not contained before.
+	 */
+	bool insert(TubeId id);
+
+	/**
+	 * Remove an id. Returns true, if the id was contained.
+	 */
+	bool remove(TubeId id);
+
+	bool contains(TubeId id) const {
+
+		if (id < 0)
+			return false;
+
+		std::size_t c = chunk(id);
+		if (c >= _chunks.size() || _chunks[c].count == 0)
+			return false;
+
+		return (_chunks[c].words[word(id)] >> bit(id)) & 1;
+	}
+
+	/**
+	 * Set union, intersection, and difference.
+	 */
+	TubeIdSet& operator|=(const TubeIdSet& other);
+	TubeIdSet& operator&=(const TubeIdSet& other);
+	TubeIdSet& operator-=(const TubeIdSet& other);
+
+	std::size_t size() const { return _size; }
+
+	bool empty() const { return _size == 0; }
+
+	void clear();
+
+	/**
+	 * The ids of this set in increasing order.
+	 */
+	TubeIds asTubeIds() const;
+
+	const_iterator begin() const { return const_iterator(*this, 0); }
+	const_iterator end() const { return const_iterator(*this, _chunks.size()); }
+
+private:
+
+	static std::size_t chunk(TubeId id) { return static_cast<std::size_t>(id) >> ChunkBits; }
+	static std::size_t word(TubeId id)  { return (static_cast<std::size_t>(id) >> 6) & (WordsPerChunk - 1); }
+	static std::size_t bit(TubeId id)   { return static_cast<std::size_t>(id) & 63; }
+
+	// recount the ids of a chunk after a set operation, and free its bits if 
+	// it became empty
+	static void recount(Chunk& chunk);
+
+	void updateSize();
+
+	std::vector<Chunk> _chunks;
+	std::size_t        _size;
+};
+
+inline TubeIdSet operator|(TubeIdSet a, const TubeIdSet& b) { return a |= b; }
+inline TubeIdSet operator&(TubeIdSet a, const TubeIdSet& b) { return a &= b; }
+inline TubeIdSet operator-(TubeIdSet a, const TubeIdSet& b) { return a -= b; }
+
+#endif // HOST_TUBES_TUBE_ID_SET_H__
@@ -2,10 +2,25 @@
 #define HOST_TUBES_TUBE_PROPERTY_MAP_H__
 
 #include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <util/exceptions.h>
 #include "TubeId.h"
 
+/**
+ * Stores the values of a TubePropertyMap in a balanced tree. Lookup and
+ * insertion take logarithmic time, iteration is in order of ids. References
+ * to values stay valid until the value is removed.
+ *
+ * This is the default storage. Values are never moved, which matters for
+ * values that are expensive to move (like the lemon graphs of skeletons and
+ * graph volumes) or that are referenced while the map is filled. Small maps
+ * of a few tubes are cheap.
+ */
 template <typename T>
-class TubePropertyMap {
+class TreeStorage {
 
 	typedef std::map<TubeId, T> map_type;
 
@@ -14,45 +29,365 @@ public:
 	typedef typename map_type::iterator       iterator;
 	typedef typename map_type::const_iterator const_iterator;
 
-	T& operator[](TubeId id) { return _map[id]; }
-	const T& operator[](TubeId id) const { return _map.at(id); }
+	T* find(TubeId id) {
+
+		iterator i = _map.find(id);
+		return (i == _map.end() ? 0 : &i->second);
+	}
+
+	const T* find(TubeId id) const {
+
+		const_iterator i = _map.find(id);
+		return (i == _map.end() ? 0 : &i->second);
+	}
+
+	T& get(TubeId id) { return _map[id]; }
+
+	bool insert(TubeId id, T&& value) { return _map.insert(std::make_pair(id, std::forward<T>(value))).second; }
+
+	template <typename Iterator>
+	void insert(Iterator begin, Iterator end) {
+
+		for (; begin != end; ++begin) {
+
+			std::pair<TubeId, T> p(*begin);
+			insert(p.first, std::move(p.second));
+		}
+	}
+
+	bool remove(TubeId id) { return _map.erase(id); }
+
+	void reserve(std::size_t) {}
+
+	iterator       begin()       { return _map.begin(); }
+	const_iterator begin() const { return _map.begin(); }
+	iterator       end()       { return _map.end(); }
+	const_iterator end() const { return _map.end(); }
+
+	void clear() { _map.clear(); }
+
+	std::size_t size() const { return _map.size(); }
+
+private:
+
+	map_type _map;
+};
+
+/**
+ * Stores the values of a TubePropertyMap contiguously in a vector, with an
+ * index from ids to positions in the vector. Lookup, insertion, and removal
+ * take constant time. Iteration is in order of insertion, until an element is
+ * removed (which moves the last element into its place). Inserting may
+ * invalidate references to values, unless enough space was reserved.
+ *
+ * The index needs memory proportional to the largest id, which is allocated
+ * and initialized as soon as an element is inserted. This is meant for maps
+ * that are filled in bulk for (almost) all tubes of a label volume, with their
+ * dense, non-negative ids. Don't use it for maps of a few tubes.
+ */
+template <typename T>
+class DenseStorage {
+
+	typedef std::vector<std::pair<TubeId, T>> vector_type;
+
+public:
+
+	typedef typename vector_type::iterator       iterator;
+	typedef typename vector_type::const_iterator const_iterator;
+
+	T* find(TubeId id) {
+
+		int i = position(id);
+		return (i < 0 ? 0 : &_values[i].second);
+	}
+
+	const T* find(TubeId id) const {
+
+		int i = position(id);
+		return (i < 0 ? 0 : &_values[i].second);
+	}
+
+	T& get(TubeId id) {
+
+		int i = position(id);
+		if (i >= 0)
+			return _values[i].second;
+
+		add(id, T());
+		return _values.back().second;
+	}
+
+	bool insert(TubeId id, T&& value) {
+
+		if (position(id) >= 0)
+			return false;
+
+		add(id, std::forward<T>(value));
+		return true;
+	}
+
+	template <typename Iterator>
+	void insert(Iterator begin, Iterator end) {
+
+		for (; begin != end; ++begin) {
+
+			std::pair<TubeId, T> p(*begin);
+			insert(p.first, std::move(p.second));
+		}
+	}
+
+	bool remove(TubeId id) {
+
+		int i = position(id);
+		if (i < 0)
+			return false;
+
+		if (static_cast<std::size_t>(i) + 1 != _values.size()) {
+
+			_values[i] = std::move(_values.back());
+			_index[_values[i].first] = i;
+		}
+
+		_values.pop_back();
+		_index[id] = -1;
+
+		return true;
+	}
+
+	void reserve(std::size_t size) { _values.reserve(size); }
+
+	iterator       begin()       { return _values.begin(); }
+	const_iterator begin() const { return _values.begin(); }
+	iterator       end()       { return _values.end(); }
+	const_iterator end() const { return _values.end(); }
+
+	void clear() {
+
+		_values.clear();
+		_index.clear();
+	}
+
+	std::size_t size() const { return _values.size(); }
+
+private:
+
+	int position(TubeId id) const {
+
+		if (id < 0 || static_cast<std::size_t>(id) >= _index.size())
+			return -1;
+
+		return _index[id];
+	}
+
+	void add(TubeId id, T&& value) {
+
+		if (id < 0)
+			UTIL_THROW_EXCEPTION(
+					UsageError,
+					"dense tube property maps can not store negative id " << id);
+
+		if (static_cast<std::size_t>(id) >= _index.size())
+			_index.resize(std::max<std::size_t>(id + 1, 2*_index.size()), -1);
+
+		_index[id] = _values.size();
+		_values.push_back(std::make_pair(id, std::forward<T>(value)));
+	}
+
+	vector_type      _values;
+	std::vector<int> _index;
+};
+
+/**
+ * Stores the values of a TubePropertyMap in a vector sorted by id. Lookup
+ * takes logarithmic time, iteration is in order of ids and as fast as over a
+ * plain vector. Inserting ids in increasing order takes constant time,
+ * otherwise linear time; use the bulk insert to add many ids in arbitrary
+ * order. Inserting may invalidate references to values.
+ */
+template <typename T>
+class SortedStorage {
+
+	typedef std::pair<TubeId, T>    value_type;
+	typedef std::vector<value_type> vector_type;
+
+public:
+
+	typedef typename vector_type::iterator       iterator;
+	typedef typename vector_type::const_iterator const_iterator;
+
+	T* find(TubeId id) {
+
+		iterator i = lowerBound(id);
+		return (i == _values.end() || i->first != id ? 0 : &i->second);
+	}
+
+	const T* find(TubeId id) const {
+
+		const_iterator i = const_cast<SortedStorage*>(this)->lowerBound(id);
+		return (i == _values.end() || i->first != id ? 0 : &i->second);
+	}
+
+	T& get(TubeId id) {
+
+		iterator i = lowerBound(id);
+
+		if (i == _values.end() || i->first != id)
+			i = _values.insert(i, value_type(id, T()));
+
+		return i->second;
+	}
+
+	bool insert(TubeId id, T&& value) {
+
+		iterator i = lowerBound(id);
+
+		if (i != _values.end() && i->first == id)
+			return false;
+
+		_values.insert(i, value_type(id, std::forward<T>(value)));
+		return true;
+	}
 
 	/**
-	 * Insert an element into the map. Returns true, if a new element was 
-	 * inserted, and false, if an existing element was overwritten.
+	 * Append all elements and sort once. Elements with ids that are contained
+	 * already are ignored, as with the single insert.
 	 */
-	bool insert(TubeId id, T&& value) { return _map.insert(std::make_pair(id, std::forward<T>(value))).second; }
+	template <typename Iterator>
+	void insert(Iterator begin, Iterator end) {
+
+		for (; begin != end; ++begin)
+			_values.push_back(value_type(*begin));
+
+		// stable, such that existing elements come before new ones with the
+		// same id
+		std::stable_sort(
+				_values.begin(),
+				_values.end(),
+				[](const value_type& a, const value_type& b) { return a.first < b.first; });
+
+		_values.erase(
+				std::unique(
+						_values.begin(),
+						_values.end(),
+						[](const value_type& a, const value_type& b) { return a.first == b.first; }),
+				_values.end());
+	}
+
+	bool remove(TubeId id) {
+
+		iterator i = lowerBound(id);
+
+		if (i == _values.end() || i->first != id)
+			return false;
+
+		_values.erase(i);
+		return true;
+	}
+
+	void reserve(std::size_t size) { _values.reserve(size); }
+
+	iterator       begin()       { return _values.begin(); }
+	const_iterator begin() const { return _values.begin(); }
+	iterator       end()       { return _values.end(); }
+	const_iterator end() const { return _values.end(); }
+
+	void clear() { _values.clear(); }
+
+	std::size_t size() const { return _values.size(); }
+
+private:
+
+	iterator lowerBound(TubeId id) {
+
+		// fast path for inserting in increasing order
+		if (_values.empty() || _values.back().first < id)
+			return _values.end();
+
+		return std::lower_bound(
+				_values.begin(),
+				_values.end(),
+				id,
+				[](const value_type& a, TubeId id) { return a.first < id; });
+	}
+
+	vector_type _values;
+};
+
+/**
+ * Maps tube ids to values of type T. The storage can be chosen per property
+ * type with the second template argument, see TreeStorage, DenseStorage, and
+ * SortedStorage.
+ */
+template <typename T, template <typename> class Storage = TreeStorage>
+class TubePropertyMap {
+
+	typedef Storage<T> storage_type;
+
+public:
+
+	typedef typename storage_type::iterator       iterator;
+	typedef typename storage_type::const_iterator const_iterator;
+
+	T& operator[](TubeId id) { return _storage.get(id); }
+
+	const T& operator[](TubeId id) const {
+
+		const T* value = _storage.find(id);
+
+		if (!value)
+			throw std::out_of_range("tube property map does not contain the requested id");
+
+		return *value;
+	}
+
+	/**
+	 * Insert an element into the map. Returns true, if a new element was
+	 * inserted, and false, if an element with the same id exists already (in
+	 * which case the map is not changed).
+	 */
+	bool insert(TubeId id, T&& value) { return _storage.insert(id, std::forward<T>(value)); }
+
+	/**
+	 * Insert a range of (id, value) pairs. Use std::make_move_iterator() to
+	 * move the values into the map.
+	 */
+	template <typename Iterator>
+	void insert(Iterator begin, Iterator end) { _storage.insert(begin, end); }
 
 	/**
 	 * Check if an element for the given id exists.
 	 */
-	bool contains(TubeId id) const { return _map.count(id); }
+	bool contains(TubeId id) const { return _storage.find(id) != 0; }
 
 	/**
-	 * Remove the element with the given id. Returns true, if the element was 
+	 * Remove the element with the given id. Returns true, if the element was
 	 * contained.
 	 */
-	bool remove(TubeId id) { return _map.erase(id); }
+	bool remove(TubeId id) { return _storage.remove(id); }
+
+	/**
+	 * Reserve memory for the given number of elements.
+	 */
+	void reserve(std::size_t size) { _storage.reserve(size); }
 
 	/**
 	 * Direct iterator access.
 	 */
-	iterator       begin()       { return _map.begin(); }
-	const_iterator begin() const { return _map.begin(); }
-	iterator       end()       { return _map.end(); }
-	const_iterator end() const { return _map.end(); }
+	iterator       begin()       { return _storage.begin(); }
+	const_iterator begin() const { return _storage.begin(); }
+	iterator       end()       { return _storage.end(); }
+	const_iterator end() const { return _storage.end(); }
 
 	/**
 	 * Clear the property map.
 	 */
-	void clear() { _map.clear(); }
+	void clear() { _storage.clear(); }
 
-	std::size_t size() const { return _map.size(); }
+	std::size_t size() const { return _storage.size(); }
 
 private:
 
-	map_type _map;
+	storage_type _storage;
 };
 
 #endif // HOST_TUBES_TUBE_PROPERTY_MAP_H__
-
@@ -6,5 +6,11 @@
 
 typedef TubePropertyMap<ExplicitVolume<unsigned char>> Volumes;
 
+/**
+ * The number of voxels of tube volumes. These maps are filled for all tubes 
+ * at once, so they are stored densely by id.
+ */
+typedef TubePropertyMap<std::size_t, DenseStorage> VolumeSizes;
+
 #endif // HOST_TUBES_VOLUMES_H__
 
@@ -19,6 +19,13 @@ SkeletonViewController::loadSkeletons(TubeIds ids) {
 void
 SkeletonViewController::onSignal(sg_gui::VolumePointSelected& signal) {
 
+	// the labels might have been read only around some tubes
+	if (!_labels->getBoundingBox().contains(
+			signal.position().x(),
+			signal.position().y(),
+			signal.position().z()))
+		return;
+
 	unsigned int x, y, z;
 	_labels->getDiscreteCoordinates(
 			signal.position().x(),
@@ -0,0 +1,222 @@
+#include <lemon/core.h>
+#include <util/ProgramOptions.h>
+#include "CachingTubeStore.h"
+
+util::ProgramOption optionTubeCacheSize(
+		util::_long_name        = "tubeCacheSize",
+		util::_description_text = "The maximal size in MB of the tube volumes, skeletons, and graph volumes to keep in memory.",
+		util::_default_value    = 1024);
+
+CachingTubeStore::CachingTubeStore(TubeStore* store, std::size_t budget) :
+	_store(store),
+	_budget(budget > 0 ? budget : optionTubeCacheSize.as<std::size_t>()*1024*1024),
+	_size(0) {}
+
+void
+CachingTubeStore::saveVolumes(const Volumes& volumes) {
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& p : volumes)
+			invalidate(_volumes, p.first);
+	}
+
+	_store->saveVolumes(volumes);
+}
+
+void
+CachingTubeStore::saveFeatures(const Features& features) {
+
+	_store->saveFeatures(features);
+}
+
+void
+CachingTubeStore::saveFeatureNames(const std::vector<std::string>& names) {
+
+	_store->saveFeatureNames(names);
+}
+
+void
+CachingTubeStore::saveSkeletons(const Skeletons& skeletons) {
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& p : skeletons)
+			invalidate(_skeletons, p.first);
+	}
+
+	_store->saveSkeletons(skeletons);
+}
+
+void
+CachingTubeStore::saveGraphVolumes(const GraphVolumes& graphVolumes) {
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (auto& p : graphVolumes)
+			invalidate(_graphVolumes, p.first);
+	}
+
+	_store->saveGraphVolumes(graphVolumes);
+}
+
+TubeIds
+CachingTubeStore::getTubeIds() {
+
+	return _store->getTubeIds();
+}
+
+TubeIds
+CachingTubeStore::getSkeletonizedTubeIds() {
+
+	return _store->getSkeletonizedTubeIds();
+}
+
+void
+CachingTubeStore::flush() {
+
+	_store->flush();
+}
+
+void
+CachingTubeStore::retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry) {
+
+	// geometry only is cheap to get, don't pollute the cache with it
+	if (onlyGeometry) {
+
+		_store->retrieveVolumes(ids, volumes, true);
+		return;
+	}
+
+	retrieveCached(VolumeEntry, _volumes, ids, volumes,
+			[this](const TubeIds& missing, Volumes& result) {
+				_store->retrieveVolumes(missing, result);
+			});
+}
+
+void
+CachingTubeStore::retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) {
+
+	_store->retrieveVolumeSizes(ids, sizes);
+}
+
+void
+CachingTubeStore::retrieveFeatures(const TubeIds& ids, Features& features) {
+
+	_store->retrieveFeatures(ids, features);
+}
+
+void
+CachingTubeStore::retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) {
+
+	retrieveCached(SkeletonEntry, _skeletons, ids, skeletons,
+			[this](const TubeIds& missing, Skeletons& result) {
+				_store->retrieveSkeletons(missing, result);
+			});
+}
+
+void
+CachingTubeStore::retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) {
+
+	retrieveCached(GraphVolumeEntry, _graphVolumes, ids, graphVolumes,
+			[this](const TubeIds& missing, GraphVolumes& result) {
+				_store->retrieveGraphVolumes(missing, result);
+			});
+}
+
+void
+CachingTubeStore::clear() {
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_volumes.clear();
+	_skeletons.clear();
+	_graphVolumes.clear();
+	_order.clear();
+	_size = 0;
+}
+
+void
+CachingTubeStore::evict() {
+
+	while (_size > _budget && !_order.empty()) {
+
+		Key key = _order.back();
+
+		switch (key.first) {
+
+			case VolumeEntry:
+				invalidate(_volumes, key.second);
+				break;
+
+			case SkeletonEntry:
+				invalidate(_skeletons, key.second);
+				break;
+
+			case GraphVolumeEntry:
+				invalidate(_graphVolumes, key.second);
+				break;
+		}
+	}
+}
+
+std::size_t
+CachingTubeStore::sizeOf(const ExplicitVolume<unsigned char>& volume) {
+
+	return sizeof(volume) + volume.data().size();
+}
+
+std::size_t
+CachingTubeStore::sizeOf(const GraphVolume& graphVolume) {
+
+	// approximate sizes of the node and edge records of lemon's ListGraph
+	return
+			sizeof(graphVolume) +
+			lemon::countNodes(graphVolume.graph())*(3*sizeof(int) + sizeof(GraphVolume::Position)) +
+			lemon::countEdges(graphVolume.graph())*(6*sizeof(int));
+}
+
+std::size_t
+CachingTubeStore::sizeOf(const Skeleton& skeleton) {
+
+	return
+			sizeOf(static_cast<const GraphVolume&>(skeleton)) +
+			lemon::countNodes(skeleton.graph())*sizeof(double);
+}
+
+GraphVolume
+CachingTubeStore::copy(const GraphVolume& graphVolume) {
+
+	GraphVolume copy;
+
+	lemon::graphCopy(graphVolume.graph(), copy.graph())
+			.nodeMap(graphVolume.positions(), copy.positions())
+			.run();
+
+	copy.setResolution(
+			graphVolume.getResolutionX(),
+			graphVolume.getResolutionY(),
+			graphVolume.getResolutionZ());
+	copy.setOffset(graphVolume.getOffset());
+
+	return copy;
+}
+
+Skeleton
+CachingTubeStore::copy(const Skeleton& skeleton) {
+
+	Skeleton copy;
+
+	lemon::graphCopy(skeleton.graph(), copy.graph())
+			.nodeMap(skeleton.positions(), copy.positions())
+			.nodeMap(skeleton.diameters(), copy.diameters())
+			.run();
+
+	copy.setResolution(
+			skeleton.getResolutionX(),
+			skeleton.getResolutionY(),
+			skeleton.getResolutionZ());
+	copy.setOffset(skeleton.getOffset());
+
+	return copy;
+}
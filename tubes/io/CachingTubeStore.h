@@ -0,0 +1,179 @@
+#ifndef HOST_TUBES_IO_CACHING_TUBE_STORE_H__
+#define HOST_TUBES_IO_CACHING_TUBE_STORE_H__
+
+#include <list>
+#include <map>
+#include <mutex>
+#include "TubeStore.h"
+
+/**
+ * A tube store decorator that keeps recently retrieved volumes, skeletons, and
+ * graph volumes in memory. Tubes are loaded from the decorated store on first
+ * access. If the cached tubes exceed the given budget in bytes, the least
+ * recently used ones are evicted. Saves are passed on to the decorated store
+ * and invalidate the cached entries of the saved tubes.
+ */
+class CachingTubeStore : public TubeStore {
+
+public:
+
+	/**
+	 * Wrap the given store. If budget is 0, the budget is taken from the
+	 * program option tubeCacheSize.
+	 */
+	CachingTubeStore(TubeStore* store, std::size_t budget = 0);
+
+	void saveVolumes(const Volumes& volumes) override;
+	void saveFeatures(const Features& features) override;
+	void saveFeatureNames(const std::vector<std::string>& names) override;
+	void saveSkeletons(const Skeletons& skeletons) override;
+	void saveGraphVolumes(const GraphVolumes& graphVolumes) override;
+
+	TubeIds getTubeIds() override;
+	TubeIds getSkeletonizedTubeIds() override;
+	void flush() override;
+
+	void retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry = false) override;
+	void retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) override;
+	void retrieveFeatures(const TubeIds& ids, Features& features) override;
+	void retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) override;
+	void retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) override;
+
+	/**
+	 * The number of bytes currently held by the cache.
+	 */
+	std::size_t getCacheSize() const { return _size; }
+
+	/**
+	 * Remove all entries from the cache.
+	 */
+	void clear();
+
+private:
+
+	enum Kind { VolumeEntry, SkeletonEntry, GraphVolumeEntry };
+
+	typedef std::pair<Kind, TubeId> Key;
+	typedef std::list<Key>          Order;
+
+	template <typename T>
+	struct Entry {
+
+		T               value;
+		std::size_t     size;
+		Order::iterator position;
+	};
+
+	template <typename T>
+	using Cache = std::map<TubeId, Entry<T>>;
+
+	/**
+	 * Fill result with the entries for ids, retrieve the missing ones from the
+	 * decorated store with retrieve(missingIds, missing) and add them to the
+	 * cache.
+	 */
+	template <typename T, typename PropertyMap, typename Retrieve>
+	void retrieveCached(
+			Kind            kind,
+			Cache<T>&       cache,
+			const TubeIds&  ids,
+			PropertyMap&    result,
+			Retrieve        retrieve) {
+
+		TubeIds missingIds;
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			for (TubeId id : ids) {
+
+				auto i = cache.find(id);
+
+				if (i == cache.end()) {
+
+					missingIds.add(id);
+					continue;
+				}
+
+				// mark as most recently used
+				_order.splice(_order.begin(), _order, i->second.position);
+
+				result.insert(id, copy(i->second.value));
+			}
+		}
+
+		if (missingIds.size() == 0)
+			return;
+
+		PropertyMap missing;
+		retrieve(missingIds, missing);
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		for (auto& p : missing) {
+
+			TubeId id = p.first;
+
+			// another thread might have been faster
+			if (!cache.count(id)) {
+
+				std::size_t size = sizeOf(p.second);
+
+				// don't cache entries that would evict everything else
+				if (size <= _budget/2) {
+
+					_order.push_front(Key(kind, id));
+
+					cache.emplace(id, Entry<T>{copy(p.second), size, _order.begin()});
+
+					_size += size;
+				}
+			}
+
+			result.insert(id, std::move(p.second));
+		}
+
+		evict();
+	}
+
+	// remove the given entry from the cache, if present
+	template <typename T>
+	void invalidate(Cache<T>& cache, TubeId id) {
+
+		auto i = cache.find(id);
+		if (i == cache.end())
+			return;
+
+		_size -= i->second.size;
+		_order.erase(i->second.position);
+		cache.erase(i);
+	}
+
+	// evict least recently used entries until the cache is within budget
+	void evict();
+
+	static std::size_t sizeOf(const ExplicitVolume<unsigned char>& volume);
+	static std::size_t sizeOf(const GraphVolume& graphVolume);
+	static std::size_t sizeOf(const Skeleton& skeleton);
+
+	static ExplicitVolume<unsigned char> copy(const ExplicitVolume<unsigned char>& volume) { return volume; }
+	static GraphVolume copy(const GraphVolume& graphVolume);
+	static Skeleton copy(const Skeleton& skeleton);
+
+	TubeStore* _store;
+
+	std::size_t _budget;
+	std::size_t _size;
+
+	Cache<ExplicitVolume<unsigned char>> _volumes;
+	Cache<Skeleton>                      _skeletons;
+	Cache<GraphVolume>                   _graphVolumes;
+
+	// the cached entries, most recently used first
+	Order _order;
+
+	std::mutex _mutex;
+};
+
+#endif // HOST_TUBES_IO_CACHING_TUBE_STORE_H__
+
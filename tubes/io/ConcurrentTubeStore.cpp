@@ -0,0 +1,152 @@
+#include "ConcurrentTubeStore.h"
+
+ConcurrentTubeStore::ConcurrentTubeStore(TubeStore* store) :
+	_store(store),
+	_stop(false),
+	_thread(&ConcurrentTubeStore::serve, this) {}
+
+ConcurrentTubeStore::~ConcurrentTubeStore() {
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+
+	_condition.notify_one();
+	_thread.join();
+}
+
+void
+ConcurrentTubeStore::saveVolumes(const Volumes& volumes) {
+
+	submit([&]() { _store->saveVolumes(volumes); }).get();
+}
+
+void
+ConcurrentTubeStore::saveFeatures(const Features& features) {
+
+	submit([&]() { _store->saveFeatures(features); }).get();
+}
+
+void
+ConcurrentTubeStore::saveFeatureNames(const std::vector<std::string>& names) {
+
+	submit([&]() { _store->saveFeatureNames(names); }).get();
+}
+
+void
+ConcurrentTubeStore::saveSkeletons(const Skeletons& skeletons) {
+
+	submit([&]() { _store->saveSkeletons(skeletons); }).get();
+}
+
+void
+ConcurrentTubeStore::saveGraphVolumes(const GraphVolumes& graphVolumes) {
+
+	submit([&]() { _store->saveGraphVolumes(graphVolumes); }).get();
+}
+
+TubeIds
+ConcurrentTubeStore::getTubeIds() {
+
+	return submit([&]() { return _store->getTubeIds(); }).get();
+}
+
+TubeIds
+ConcurrentTubeStore::getSkeletonizedTubeIds() {
+
+	return submit([&]() { return _store->getSkeletonizedTubeIds(); }).get();
+}
+
+void
+ConcurrentTubeStore::flush() {
+
+	submit([&]() { _store->flush(); }).get();
+}
+
+void
+ConcurrentTubeStore::retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry) {
+
+	submit([&]() { _store->retrieveVolumes(ids, volumes, onlyGeometry); }).get();
+}
+
+void
+ConcurrentTubeStore::retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) {
+
+	submit([&]() { _store->retrieveVolumeSizes(ids, sizes); }).get();
+}
+
+void
+ConcurrentTubeStore::retrieveFeatures(const TubeIds& ids, Features& features) {
+
+	submit([&]() { _store->retrieveFeatures(ids, features); }).get();
+}
+
+void
+ConcurrentTubeStore::retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) {
+
+	submit([&]() { _store->retrieveSkeletons(ids, skeletons); }).get();
+}
+
+void
+ConcurrentTubeStore::retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) {
+
+	submit([&]() { _store->retrieveGraphVolumes(ids, graphVolumes); }).get();
+}
+
+std::future<Volumes>
+ConcurrentTubeStore::retrieveVolumesAsync(const TubeIds& ids, bool onlyGeometry) {
+
+	// ids are copied, the caller might be gone by the time we get to it
+	return submit([this, ids, onlyGeometry]() {
+
+		Volumes volumes;
+		_store->retrieveVolumes(ids, volumes, onlyGeometry);
+		return volumes;
+	});
+}
+
+std::future<Skeletons>
+ConcurrentTubeStore::retrieveSkeletonsAsync(const TubeIds& ids) {
+
+	return submit([this, ids]() {
+
+		Skeletons skeletons;
+		_store->retrieveSkeletons(ids, skeletons);
+		return skeletons;
+	});
+}
+
+std::future<GraphVolumes>
+ConcurrentTubeStore::retrieveGraphVolumesAsync(const TubeIds& ids) {
+
+	return submit([this, ids]() {
+
+		GraphVolumes graphVolumes;
+		_store->retrieveGraphVolumes(ids, graphVolumes);
+		return graphVolumes;
+	});
+}
+
+void
+ConcurrentTubeStore::serve() {
+
+	while (true) {
+
+		std::function<void()> request;
+
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_condition.wait(lock, [this]() { return _stop || !_queue.empty(); });
+
+			if (_queue.empty())
+				return;
+
+			request = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		// exceptions are passed on through the future
+		request();
+	}
+}
@@ -0,0 +1,107 @@
+#ifndef HOST_TUBES_IO_CONCURRENT_TUBE_STORE_H__
+#define HOST_TUBES_IO_CONCURRENT_TUBE_STORE_H__
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <deque>
+#include <memory>
+#include "TubeStore.h"
+
+/**
+ * A tube store decorator that can be used from many threads at once. All 
+ * accesses to the decorated store are executed in order by a single I/O 
+ * thread, since HDF5 can not be used concurrently from several threads. The 
+ * asynchronous retrieve methods return immediately, such that I/O for the 
+ * next tubes can overlap with computations on the current ones.
+ */
+class ConcurrentTubeStore : public TubeStore {
+
+public:
+
+	/**
+	 * Wrap the given store. The store should not be used directly anymore 
+	 * while this decorator exists.
+	 */
+	ConcurrentTubeStore(TubeStore* store);
+
+	/**
+	 * Finishes all pending requests and stops the I/O thread.
+	 */
+	~ConcurrentTubeStore();
+
+	void saveVolumes(const Volumes& volumes) override;
+	void saveFeatures(const Features& features) override;
+	void saveFeatureNames(const std::vector<std::string>& names) override;
+	void saveSkeletons(const Skeletons& skeletons) override;
+	void saveGraphVolumes(const GraphVolumes& graphVolumes) override;
+
+	TubeIds getTubeIds() override;
+	TubeIds getSkeletonizedTubeIds() override;
+	void flush() override;
+
+	void retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry = false) override;
+	void retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) override;
+	void retrieveFeatures(const TubeIds& ids, Features& features) override;
+	void retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) override;
+	void retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) override;
+
+	/**
+	 * Queue a request for the volumes of the given tubes and return 
+	 * immediately. Requests are served in the order they were made.
+	 */
+	std::future<Volumes> retrieveVolumesAsync(const TubeIds& ids, bool onlyGeometry = false);
+
+	/**
+	 * Queue a request for the skeletons of the given tubes.
+	 */
+	std::future<Skeletons> retrieveSkeletonsAsync(const TubeIds& ids);
+
+	/**
+	 * Queue a request for the graph volumes of the given tubes.
+	 */
+	std::future<GraphVolumes> retrieveGraphVolumesAsync(const TubeIds& ids);
+
+	/**
+	 * Queue an arbitrary function to be executed by the I/O thread and return 
+	 * its result as a future. Use this for other HDF5 accesses (like a volume 
+	 * store on the same project file) that have to be serialized with the 
+	 * accesses to the tube store.
+	 */
+	template <typename F>
+	std::future<typename std::result_of<F()>::type> submit(F f) {
+
+		typedef typename std::result_of<F()>::type Result;
+
+		auto task = std::make_shared<std::packaged_task<Result()>>(f);
+		std::future<Result> result = task->get_future();
+
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_queue.push_back([task](){ (*task)(); });
+		}
+
+		_condition.notify_one();
+
+		return result;
+	}
+
+private:
+
+	// the main loop of the I/O thread
+	void serve();
+
+	TubeStore* _store;
+
+	std::mutex                        _mutex;
+	std::condition_variable           _condition;
+	std::deque<std::function<void()>> _queue;
+	bool                              _stop;
+
+	std::thread _thread;
+};
+
+#endif // HOST_TUBES_IO_CONCURRENT_TUBE_STORE_H__
+
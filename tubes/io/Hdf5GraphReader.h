@@ -1,6 +1,7 @@
 #ifndef HOST_TUBES_IO_HDF5_GRAPH_READER_H__
 #define HOST_TUBES_IO_HDF5_GRAPH_READER_H__
 
+#include <vector>
 #include <vigra/hdf5impex.hxx>
 #include <lemon/list_graph.h>
 
@@ -9,7 +10,7 @@ class Hdf5GraphReader {
 public:
 
 	/**
-	 * Converts numeric types into array-like objects for HDF5 storage.
+	 * Reads numeric types from arrays in HDF5 storage.
 	 */
 	template <typename T>
 	struct DefaultConverter {
@@ -17,7 +18,7 @@ public:
 		typedef T ArrayValueType;
 		static const int ArraySize = 1;
 
-		T operator()(const vigra::ArrayVectorView<T>& array) const {
+		T operator()(const T* array) const {
 
 			return array[0];
 		}
@@ -41,20 +42,22 @@ public:
 
 	/**
 	 * Read a node map from a dataset with the given name. A converter object 
-	 * needs to be provided to transform ArrayVectorView<T> objects into 
-	 * ValueType. Converter has to define:
+	 * needs to be provided to create ValueType objects from memory-consecutive 
+	 * fields of type T. Converter has to define:
 	 *
 	 *   Converter::ArrayValueType
 	 *
-	 *     the expected type T of the ArrayVectorView<T>
+	 *     the expected type T of the fields
 	 *
 	 *   Converter::ArraySize
 	 *
-	 *     the number of elements in the array
+	 *     the number of elements per field
 	 *
-	 *   ValueType operator()(const ArrayVectorView<T>& a)
+	 *   ValueType operator()(const T* array)
 	 *
-	 *     the conversion operator
+	 *     the conversion operator, reads ArraySize elements from array
+	 *
+	 * If the dataset does not exist, the map is not changed.
 	 */
 	template <typename ValueType, typename Converter = DefaultConverter<ValueType>>
 	void readNodeMap(
@@ -63,36 +66,66 @@ public:
 			std::string         name,
 			const Converter&    converter = Converter()) {
 
-		typedef vigra::ArrayVector<typename Converter::ArrayValueType> ArrayType;
+		typedef typename Converter::ArrayValueType ArrayValueType;
 
-		ArrayType values;
+		if (!_hdfFile.existsDataset(name))
+			return;
 
-		if (_hdfFile.existsDataset(name))
-			_hdfFile.readAndResize(
-					name,
-					values);
+		vigra::ArrayVector<ArrayValueType> values;
+		_hdfFile.readAndResize(
+				name,
+				values);
 
-		for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+		const ArrayValueType* data = values.data();
 
-			std::size_t i = graph.id(node);
-			map[node] = converter(values.subarray(i*Converter::ArraySize, (i + 1)*Converter::ArraySize));
-		}
+		for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
+			map[node] = converter(data + Converter::ArraySize*graph.id(node));
 	}
 
 	/**
-	 * Stores an edge map in a dataset with the given name.
+	 * Read an edge map from a dataset with the given name, as written by 
+	 * Hdf5GraphWriter::writeEdgeMap() for a graph that was read with 
+	 * readGraph(). A converter object needs to be provided to create ValueType 
+	 * objects from memory-consecutive fields of type T, as for readNodeMap(). 
+	 * If the dataset does not exist, the map is not changed.
 	 */
-	template <typename ValueType>
-	void readEdgeMap(const EdgeMap<ValueType>& map, std::string name);
+	template <typename ValueType, typename Converter = DefaultConverter<ValueType>>
+	void readEdgeMap(
+			const Graph&        graph,
+			EdgeMap<ValueType>& map,
+			std::string         name,
+			const Converter&    converter = Converter()) {
+
+		typedef typename Converter::ArrayValueType ArrayValueType;
+
+		if (!_hdfFile.existsDataset(name))
+			return;
+
+		vigra::ArrayVector<ArrayValueType> values;
+		_hdfFile.readAndResize(
+				name,
+				values);
+
+		const ArrayValueType* data = values.data();
+
+		// readGraph() adds the edges in the order in which they are stored
+		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge)
+			map[edge] = converter(data + Converter::ArraySize*graph.id(edge));
+	}
 
 	/**
 	 * Read an edge map with entries of variable length from a dataset with the 
-	 * given name. ContainerType has to define:
+	 * given name, as written by Hdf5GraphWriter::writeVarLengthEdgeMap() for a 
+	 * graph that was read with readGraph(). ContainerType has to define:
 	 *
 	 *   ContainerType::clear()
 	 *
 	 *     empty the container
 	 *
+	 *   ContainerType::reserve(std::size_t)
+	 *
+	 *     preallocate memory for the given number of elements
+	 *
 	 *   ContainerType::push_back(ContainerType::value_type)
 	 *
 	 *     add an element to the container
@@ -105,20 +138,9 @@ public:
 	 *
 	 *     number of elements in the collection
 	 *
-	 * A converter object needs to be provided to transform ArrayVectorView<T> 
-	 * into ContainerType::value_type. Converter has to define:
-	 *
-	 *   Converter::ArrayValueType
-	 *
-	 *     the expected type T of the ArrayVectorView<T>
-	 *
-	 *   Converter::ArraySize
-	 *
-	 *     the number of elements in the array
-	 *
-	 *   ValueType operator()(const ArrayVectorView<T>& a)
-	 *
-	 *     the conversion operator
+	 * A converter object needs to be provided to create 
+	 * ContainerType::value_type objects from memory-consecutive fields of type 
+	 * T, as for readNodeMap().
 	 */
 	template <typename ContainerType, typename Converter>
 	void readVarLengthEdgeMap(
@@ -127,11 +149,10 @@ public:
 			std::string             name,
 			const Converter&        converter) {
 
-		typedef typename ContainerType::value_type                     ValueType;
-		typedef vigra::ArrayVector<typename Converter::ArrayValueType> ArrayType;
+		typedef typename Converter::ArrayValueType ArrayValueType;
 
-		ArrayType               values;
-		vigra::ArrayVector<int> chunks;
+		vigra::ArrayVector<ArrayValueType> values;
+		vigra::ArrayVector<int>            chunks;
 
 		if (_hdfFile.existsDataset(name + "_values"))
 			_hdfFile.readAndResize(
@@ -146,20 +167,25 @@ public:
 		if (values.size() == 0 || chunks.size() == 0)
 			return;
 
-		int edgeNum     = 0;
-		int nextElement = 0;
+		// the start of the elements of each stored edge
+		std::vector<std::size_t> starts(chunks.size() + 1, 0);
+		for (std::size_t i = 0; i < chunks.size(); i++)
+			starts[i + 1] = starts[i] + Converter::ArraySize*chunks[i];
+
+		// readGraph() adds the edges in the order in which they are stored
 		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
 
-			map[edge].clear();
-			int numElements = chunks[edgeNum];
+			ContainerType& elements    = map[edge];
+			int            i           = graph.id(edge);
+			int            numElements = chunks[i];
 
-			for (int i = 0; i < numElements; i++) {
+			const ArrayValueType* data = values.data() + starts[i];
 
-				map[edge].push_back(converter(values.subarray(nextElement, nextElement + Converter::ArraySize)));
-				nextElement += Converter::ArraySize;
-			}
+			elements.clear();
+			elements.reserve(numElements);
 
-			edgeNum++;
+			for (int j = 0; j < numElements; j++, data += Converter::ArraySize)
+				elements.push_back(converter(data));
 		}
 	}
 private:
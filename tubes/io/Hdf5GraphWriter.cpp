@@ -3,83 +3,43 @@
 void
 Hdf5GraphWriter::writeGraph(const Hdf5GraphWriter::Graph& graph) {
 
-	int numNodes = 0;
-	for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
-		numNodes++;
+	std::vector<int> nodeIndex;
+	int numNodes = createNodeIndex(graph, nodeIndex);
 
 	vigra::ArrayVector<int> n(1);
-	vigra::ArrayVector<int> edges; // stored in pairs
-
 	n[0] = numNodes;
 	_hdfFile.write("num_nodes", n);
 
-	if (!nodeIdsConsequtive(graph)) {
-
-		// create map from node ids to consecutive ids
-		std::map<int, int> nodeMap = createNodeMap(graph);
-
-		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
-
-			edges.push_back(nodeMap[graph.id(graph.u(edge))]);
-			edges.push_back(nodeMap[graph.id(graph.v(edge))]);
-		}
+	int numEdges = 0;
+	for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge)
+		numEdges++;
 
-	} else {
+	// stored in pairs
+	vigra::ArrayVector<int> edges(2*numEdges);
 
-		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
+	int* data = edges.data();
+	for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
 
-			edges.push_back(graph.id(graph.u(edge)));
-			edges.push_back(graph.id(graph.v(edge)));
-		}
+		*data++ = nodeIndex[graph.id(graph.u(edge))];
+		*data++ = nodeIndex[graph.id(graph.v(edge))];
 	}
 
 	_hdfFile.write("edges", edges);
 }
 
-bool
-Hdf5GraphWriter::nodeIdsConsequtive(const Hdf5GraphWriter::Graph& graph) {
-
-	int i = -1;
-	bool ascending;
-
-	for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
-
-		if (i == -1) {
-
-			if (graph.id(node) != 0) {
-
-				i = graph.id(node);
-				ascending = false;
+int
+Hdf5GraphWriter::createNodeIndex(const Hdf5GraphWriter::Graph& graph, std::vector<int>& nodeIndex) {
 
-			} else {
+	nodeIndex.assign(graph.maxNodeId() + 1, -1);
 
-				i = 0;
-				ascending = true;
-			}
-		}
-
-		if (graph.id(node) != i)
-			return false;
-
-		if (ascending)
-			i++;
-		else
-			i--;
-	}
-
-	return true;
-}
-
-std::map<int, int>
-Hdf5GraphWriter::createNodeMap(const Hdf5GraphWriter::Graph& graph) {
-
-	std::map<int, int> nodeMap;
-	int i = 0;
-	for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+	int numNodes = 0;
+	for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
+		nodeIndex[graph.id(node)] = numNodes++;
 
-		nodeMap[graph.id(node)] = i;
-		i++;
-	}
+	// all ids are in use, store the nodes by id
+	if (static_cast<std::size_t>(numNodes) == nodeIndex.size())
+		for (int i = 0; i < numNodes; i++)
+			nodeIndex[i] = i;
 
-	return nodeMap;
+	return numNodes;
 }
@@ -1,7 +1,7 @@
 #ifndef HOST_TUBES_IO_HDF5_GRAPH_WRITER_H__
 #define HOST_TUBES_IO_HDF5_GRAPH_WRITER_H__
 
-#include <map>
+#include <vector>
 #include <vigra/hdf5impex.hxx>
 #include <lemon/list_graph.h>
 
@@ -10,7 +10,7 @@ class Hdf5GraphWriter {
 public:
 
 	/**
-	 * Converts numeric types into array-like objects for HDF5 storage.
+	 * Writes numeric types into arrays for HDF5 storage.
 	 */
 	template <typename T>
 	struct DefaultConverter {
@@ -18,11 +18,9 @@ public:
 		typedef T ArrayValueType;
 		static const int ArraySize = 1;
 
-		vigra::ArrayVector<T> operator()(const T& t) const {
+		void operator()(const T& t, T* array) const {
 
-			vigra::ArrayVector<T> array(1);
 			array[0] = t;
-			return array;
 		}
 	};
 
@@ -44,20 +42,23 @@ public:
 
 	/**
 	 * Stores a node map in a dataset with the given name. A converter object 
-	 * needs to be provided to transform ValueTypes into ArrayVectorView<T>, 
-	 * i.e., memory-consecutive fields of type T. Converter has to define:
+	 * needs to be provided to write ValueTypes into memory-consecutive fields 
+	 * of type T. Converter has to define:
 	 *
 	 *   Converter::ArrayValueType
 	 *
-	 *     the type T of the ArrayVectorView<T>
+	 *     the type T of the fields
 	 *
 	 *   Converter::ArraySize
 	 *
-	 *     the number of elements in the array
+	 *     the number of elements per field
 	 *
-	 *   ArrayVectorView<T> operator()(const ValueType& v)
+	 *   void operator()(const ValueType& v, T* array)
 	 *
-	 *     the conversion operator
+	 *     the conversion operator, writes ArraySize elements to array
+	 *
+	 * The values of all nodes are converted directly into the buffer that is 
+	 * written to the dataset.
 	 */
 	template <typename ValueType, typename Converter = DefaultConverter<ValueType>>
 	void writeNodeMap(
@@ -66,31 +67,49 @@ public:
 			std::string               name,
 			const Converter&          converter = Converter()) {
 
-		typedef vigra::ArrayVector<typename Converter::ArrayValueType> ArrayType;
+		typedef typename Converter::ArrayValueType ArrayValueType;
 
-		int numNodes = 0;
-		for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
-			numNodes++;
+		std::vector<int> nodeIndex;
+		int numNodes = createNodeIndex(graph, nodeIndex);
 
-		ArrayType values(Converter::ArraySize*numNodes);
+		vigra::ArrayVector<ArrayValueType> values(Converter::ArraySize*numNodes);
+		ArrayValueType* data = values.data();
 
-		if (!nodeIdsConsequtive(graph)) {
+		for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node)
+			converter(map[node], data + Converter::ArraySize*nodeIndex[graph.id(node)]);
 
-			std::map<int, int> nodeMap = createNodeMap(graph);
+		if (values.size() > 0)
+			_hdfFile.write(
+					name,
+					values);
+	}
+
+	/**
+	 * Stores an edge map in a dataset with the given name, in the order in 
+	 * which writeGraph() stores the edges. A converter object needs to be 
+	 * provided to write ValueTypes into memory-consecutive fields of type T, 
+	 * as for writeNodeMap().
+	 */
+	template <typename ValueType, typename Converter = DefaultConverter<ValueType>>
+	void writeEdgeMap(
+			const Graph&              graph,
+			const EdgeMap<ValueType>& map,
+			std::string               name,
+			const Converter&          converter = Converter()) {
 
-			for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+		typedef typename Converter::ArrayValueType ArrayValueType;
 
-				ArrayType v = converter(map[node]);
-				std::copy(v.begin(), v.end(), values.begin() + Converter::ArraySize*nodeMap[graph.id(node)]);
-			}
+		int numEdges = 0;
+		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge)
+			numEdges++;
 
-		} else {
+		vigra::ArrayVector<ArrayValueType> values(Converter::ArraySize*numEdges);
+		ArrayValueType* data = values.data();
 
-			for (Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
 
-				ArrayType v = converter(map[node]);
-				std::copy(v.begin(), v.end(), values.begin() + Converter::ArraySize*graph.id(node));
-			}
+			converter(map[edge], data);
+			data += Converter::ArraySize;
 		}
 
 		if (values.size() > 0)
@@ -99,29 +118,10 @@ public:
 					values);
 	}
 
-	/**
-	 * Stores an edge map in a dataset with the given name. A converter object 
-	 * needs to be provided to transform ValueTypes into ArrayVectorView<T>, 
-	 * i.e., memory-consecutive fields of type T. Converter has to define:
-	 *
-	 *   Converter::ArrayValueType
-	 *
-	 *     the type T of the ArrayVectorView<T>
-	 *
-	 *   Converter::ArraySize
-	 *
-	 *     the number of elements in the array
-	 *
-	 *   ArrayVectorView<T> operator()(const ValueType& v)
-	 *
-	 *     the conversion operator
-	 */
-	template <typename ValueType>
-	void writeEdgeMap(const EdgeMap<ValueType>& map, std::string name);
-
 	/**
 	 * Stores an edge map with entries of variable length in a dataset with the 
-	 * given name. ContainerType has to define:
+	 * given name, in the order in which writeGraph() stores the edges. 
+	 * ContainerType has to define:
 	 *
 	 *   ContainerType::begin(), ContainerType::end()
 	 *
@@ -135,21 +135,9 @@ public:
 	 *
 	 *     number of elements in the collection
 	 *
-	 * A converter object needs to be provided to transform 
-	 * ContainerType::value_type into ArrayVectorView<T>, i.e., 
-	 * memory-consecutive fields of type T. Converter has to define:
-	 *
-	 *   Converter::ArrayValueType
-	 *
-	 *     the type T of the ArrayVectorView<T>
-	 *
-	 *   Converter::ArraySize
-	 *
-	 *     the number of elements in the array
-	 *
-	 *   ArrayVectorView<T> operator()(const ValueType& v)
-	 *
-	 *     the conversion operator
+	 * A converter object needs to be provided to write 
+	 * ContainerType::value_type into memory-consecutive fields of type T, as 
+	 * for writeNodeMap().
 	 */
 	template <typename ContainerType, typename Converter>
 	void writeVarLengthEdgeMap(
@@ -158,23 +146,26 @@ public:
 			std::string                   name,
 			const Converter&              converter) {
 
-		typedef typename ContainerType::value_type                     ValueType;
-		typedef vigra::ArrayVector<typename Converter::ArrayValueType> ArrayType;
+		typedef typename Converter::ArrayValueType ArrayValueType;
 
-		ArrayType               values;
 		vigra::ArrayVector<int> chunks;
 
+		std::size_t numElements = 0;
 		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge) {
 
-			const ContainerType& edgeElements = map[edge];
+			chunks.push_back(map[edge].size());
+			numElements += map[edge].size();
+		}
 
-			chunks.push_back(edgeElements.size());
-			for (auto& element : edgeElements) {
+		vigra::ArrayVector<ArrayValueType> values(Converter::ArraySize*numElements);
+		ArrayValueType* data = values.data();
 
-				ArrayType v = converter(element);
-				std::copy(v.begin(), v.end(), std::back_inserter(values));
+		for (Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge)
+			for (auto& element : map[edge]) {
+
+				converter(element, data);
+				data += Converter::ArraySize;
 			}
-		}
 
 		_hdfFile.write(name + "_values", values);
 		_hdfFile.write(name + "_chunks", chunks);
@@ -182,9 +173,13 @@ public:
 
 private:
 
-	bool nodeIdsConsequtive(const Hdf5GraphWriter::Graph& graph);
-
-	std::map<int, int> createNodeMap(const Hdf5GraphWriter::Graph& graph);
+	/**
+	 * Fill nodeIndex with the index under which each node is stored, indexed 
+	 * by node id. If the node ids are consecutive, the index of a node is its 
+	 * id, otherwise nodes are numbered in iteration order. Returns the number 
+	 * of nodes.
+	 */
+	int createNodeIndex(const Graph& graph, std::vector<int>& nodeIndex);
 
 	vigra::HDF5File& _hdfFile;
 };
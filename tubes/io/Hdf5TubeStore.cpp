@@ -1,9 +1,320 @@
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
 #include <boost/lexical_cast.hpp>
 #include <util/Logger.h>
+#include <util/exceptions.h>
+#include <tubes/TubeIdSet.h>
 #include "Hdf5TubeStore.h"
 
 logger::LogChannel hdf5storelog("hdf5storelog", "[Hdf5TubeStore] ");
 
+namespace {
+
+const char* FeatureMatrixDataset = "/tubes/feature_matrix";
+const char* FeatureIdsDataset    = "/tubes/feature_ids";
+
+// the names of the columns of the feature matrix
+const char* FeatureNamesAttribute = "feature_names";
+
+// pairs of a row in a dataset and a row or tube id in memory, sorted by the 
+// dataset row
+typedef std::vector<std::pair<hsize_t, std::size_t>> Rows;
+
+// the number of columns of a 2D dataset
+hsize_t numDatasetColumns(hid_t dataset) {
+
+	vigra::HDF5Handle space(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+
+	hsize_t dims[2];
+	H5Sget_simple_extent_dims(space, dims, NULL);
+
+	return dims[1];
+}
+
+// select the given rows of a 2D dataspace, merging consecutive rows into 
+// single hyperslabs
+void selectRows(hid_t space, const Rows& rows, hsize_t numColumns) {
+
+	H5Sselect_none(space);
+
+	std::size_t begin = 0;
+	while (begin < rows.size()) {
+
+		std::size_t end = begin + 1;
+		while (end < rows.size() && rows[end].first == rows[end - 1].first + 1)
+			end++;
+
+		hsize_t start[2] = { rows[begin].first, 0 };
+		hsize_t count[2] = { end - begin, numColumns };
+
+		H5Sselect_hyperslab(space, H5S_SELECT_OR, start, NULL, count, NULL);
+
+		begin = end;
+	}
+}
+
+
+const std::string PackedSkeletonsGroup    = "/tubes/packed_skeletons/";
+const std::string PackedGraphVolumesGroup = "/tubes/packed_graph_volumes/";
+
+// per-node values that are stored in addition to the positions, only 
+// skeletons have diameters
+bool hasDiameters(const Skeletons&)    { return true; }
+bool hasDiameters(const GraphVolumes&) { return false; }
+
+void appendDiameters(const Skeleton& skeleton, std::vector<double>& diameters) {
+
+	for (Skeleton::Graph::NodeIt node(skeleton.graph()); node != lemon::INVALID; ++node)
+		diameters.push_back(skeleton.diameters()[node]);
+}
+void appendDiameters(const GraphVolume&, std::vector<double>&) {}
+
+void setDiameters(Skeleton& skeleton, const std::vector<Skeleton::Node>& nodes, const double* diameters) {
+
+	for (std::size_t i = 0; i < nodes.size(); i++)
+		skeleton.diameters()[nodes[i]] = diameters[i];
+}
+void setDiameters(GraphVolume&, const std::vector<GraphVolume::Node>&, const double*) {}
+
+// the number of tubes that have been stored completely in a packed group
+hsize_t numPackedTubes(hid_t file, const std::string& group) {
+
+	return getHdf5DatasetSize(file, group + "ids");
+}
+
+// read the first n entries of a per-tube dataset of a packed group
+template <typename T>
+std::vector<T> readPackedTable(hid_t file, const std::string& path, hsize_t n) {
+
+	std::vector<T> values;
+	readHdf5Ranges(file, path, Hdf5Ranges(1, std::make_pair(hsize_t(0), n)), values);
+	return values;
+}
+
+/**
+ * Append graph volumes or skeletons to a packed group. The nodes, edges, and 
+ * node maps of all tubes are concatenated into one dataset each, per-tube 
+ * datasets store where the data of each tube starts. The ids are written 
+ * last: only the first numPackedTubes() entries of the per-tube datasets are 
+ * valid, everything beyond is left over from an interrupted save and gets 
+ * truncated here.
+ *
+ * Tubes that are stored already are appended again, readPacked() uses their 
+ * last entry. Older entries are never removed, such that a save never 
+ * touches data that is valid already. The datasets therefore grow with each 
+ * re-save of a tube (a full skeletonRecompute about doubles them). HDF5 does 
+ * not return freed space to the file either, so the only way to get rid of 
+ * old entries is to extract into a new project file.
+ */
+template <typename PropertyMap>
+void writePacked(hid_t file, const std::string& group, const PropertyMap& graphVolumes) {
+
+	hsize_t numTubes = numPackedTubes(file, group);
+	hsize_t numNodes = 0;
+	hsize_t numEdges = 0;
+
+	if (numTubes > 0) {
+
+		Hdf5Ranges last(1, std::make_pair(numTubes - 1, hsize_t(1)));
+
+		std::vector<long long> nodeOffset, edgeOffset;
+		std::vector<int>       nodeCount, edgeCount;
+		readHdf5Ranges(file, group + "node_offsets", last, nodeOffset);
+		readHdf5Ranges(file, group + "edge_offsets", last, edgeOffset);
+		readHdf5Ranges(file, group + "num_nodes", last, nodeCount);
+		readHdf5Ranges(file, group + "num_edges", last, edgeCount);
+
+		numNodes = nodeOffset[0] + nodeCount[0];
+		numEdges = edgeOffset[0] + edgeCount[0];
+	}
+
+	for (const char* name : { "num_nodes", "num_edges", "node_offsets", "edge_offsets" })
+		resizeHdf5Dataset(file, group + name, numTubes);
+	for (const char* name : { "resolutions", "offsets" })
+		resizeHdf5Dataset(file, group + name, 3*numTubes);
+	resizeHdf5Dataset(file, group + "positions", 3*numNodes);
+	resizeHdf5Dataset(file, group + "diameters", numNodes);
+	resizeHdf5Dataset(file, group + "edges", 2*numEdges);
+
+	std::vector<TubeId>    ids;
+	std::vector<int>       nodeCounts, edgeCounts, edges;
+	std::vector<long long> nodeOffsets, edgeOffsets;
+	std::vector<float>     positions, resolutions, offsets;
+	std::vector<double>    diameters;
+
+	for (auto& p : graphVolumes) {
+
+		const GraphVolume&            graphVolume = p.second;
+		const Hdf5GraphWriter::Graph& graph       = graphVolume.graph();
+
+		// nodes are stored with consecutive local indices in iteration order
+		Hdf5GraphWriter::NodeMap<int> index(graph);
+
+		int n = 0;
+		for (Hdf5GraphWriter::Graph::NodeIt node(graph); node != lemon::INVALID; ++node) {
+
+			index[node] = n++;
+
+			for (int i = 0; i < 3; i++)
+				positions.push_back(graphVolume.positions()[node][i]);
+		}
+
+		int e = 0;
+		for (Hdf5GraphWriter::Graph::EdgeIt edge(graph); edge != lemon::INVALID; ++edge, ++e) {
+
+			edges.push_back(index[graph.u(edge)]);
+			edges.push_back(index[graph.v(edge)]);
+		}
+
+		appendDiameters(p.second, diameters);
+
+		ids.push_back(p.first);
+		nodeCounts.push_back(n);
+		edgeCounts.push_back(e);
+		nodeOffsets.push_back(numNodes);
+		edgeOffsets.push_back(numEdges);
+		numNodes += n;
+		numEdges += e;
+
+		resolutions.push_back(graphVolume.getResolutionX());
+		resolutions.push_back(graphVolume.getResolutionY());
+		resolutions.push_back(graphVolume.getResolutionZ());
+		offsets.push_back(graphVolume.getOffset().x());
+		offsets.push_back(graphVolume.getOffset().y());
+		offsets.push_back(graphVolume.getOffset().z());
+	}
+
+	appendToHdf5Dataset(file, group + "positions", positions);
+	if (hasDiameters(graphVolumes))
+		appendToHdf5Dataset(file, group + "diameters", diameters);
+	appendToHdf5Dataset(file, group + "edges", edges);
+
+	appendToHdf5Dataset(file, group + "num_nodes", nodeCounts);
+	appendToHdf5Dataset(file, group + "num_edges", edgeCounts);
+	appendToHdf5Dataset(file, group + "node_offsets", nodeOffsets);
+	appendToHdf5Dataset(file, group + "edge_offsets", edgeOffsets);
+	appendToHdf5Dataset(file, group + "resolutions", resolutions);
+	appendToHdf5Dataset(file, group + "offsets", offsets);
+
+	appendToHdf5Dataset(file, group + "ids", ids);
+}
+
+/**
+ * Read graph volumes or skeletons from a packed group, with a single read per 
+ * dataset. Returns the ids that are not stored in the packed group.
+ */
+template <typename GraphVolumeType, typename PropertyMap>
+TubeIds readPacked(hid_t file, const std::string& group, const TubeIds& ids, PropertyMap& graphVolumes) {
+
+	hsize_t numTubes = numPackedTubes(file, group);
+
+	if (numTubes == 0)
+		return ids;
+
+	std::vector<TubeId>    storedIds   = readPackedTable<TubeId>(file, group + "ids", numTubes);
+	std::vector<int>       nodeCounts  = readPackedTable<int>(file, group + "num_nodes", numTubes);
+	std::vector<int>       edgeCounts  = readPackedTable<int>(file, group + "num_edges", numTubes);
+	std::vector<long long> nodeOffsets = readPackedTable<long long>(file, group + "node_offsets", numTubes);
+	std::vector<long long> edgeOffsets = readPackedTable<long long>(file, group + "edge_offsets", numTubes);
+
+	// tubes that were saved several times are read from their last entry
+	std::unordered_map<TubeId, hsize_t> entries;
+	for (std::size_t i = 0; i < storedIds.size(); i++)
+		entries[storedIds[i]] = i;
+
+	std::vector<hsize_t> requested;
+	TubeIds              missing;
+
+	for (TubeId id : ids) {
+
+		auto entry = entries.find(id);
+
+		if (entry == entries.end())
+			missing.add(id);
+		else
+			requested.push_back(entry->second);
+	}
+
+	// the ranges of all datasets have to be in file order
+	std::sort(requested.begin(), requested.end());
+	requested.erase(std::unique(requested.begin(), requested.end()), requested.end());
+
+	Hdf5Ranges positionRanges, diameterRanges, edgeRanges, geometryRanges;
+
+	for (hsize_t i : requested) {
+
+		positionRanges.push_back(std::make_pair(3*nodeOffsets[i], 3*nodeCounts[i]));
+		diameterRanges.push_back(std::make_pair(nodeOffsets[i], nodeCounts[i]));
+		edgeRanges.push_back(std::make_pair(2*edgeOffsets[i], 2*edgeCounts[i]));
+		geometryRanges.push_back(std::make_pair(3*i, 3));
+	}
+
+	std::vector<float>  positions, resolutions, offsets;
+	std::vector<int>    edges;
+	std::vector<double> diameters;
+
+	readHdf5Ranges(file, group + "positions", positionRanges, positions);
+	readHdf5Ranges(file, group + "edges", edgeRanges, edges);
+	readHdf5Ranges(file, group + "resolutions", geometryRanges, resolutions);
+	readHdf5Ranges(file, group + "offsets", geometryRanges, offsets);
+	if (hasDiameters(graphVolumes))
+		readHdf5Ranges(file, group + "diameters", diameterRanges, diameters);
+
+	const float*  position = positions.data();
+	const int*    edge     = edges.data();
+	const double* diameter = diameters.data();
+
+	for (std::size_t r = 0; r < requested.size(); r++) {
+
+		hsize_t i = requested[r];
+
+		LOG_ALL(hdf5storelog) << "reading packed graph volume for tube " << storedIds[i] << std::endl;
+
+		GraphVolumeType graphVolume;
+
+		std::vector<typename GraphVolumeType::Node> nodes;
+		nodes.reserve(nodeCounts[i]);
+
+		for (int n = 0; n < nodeCounts[i]; n++, position += 3) {
+
+			nodes.push_back(graphVolume.graph().addNode());
+
+			Skeleton::Position& pos = graphVolume.positions()[nodes.back()];
+			for (int d = 0; d < 3; d++)
+				pos[d] = position[d];
+		}
+
+		for (int e = 0; e < edgeCounts[i]; e++, edge += 2)
+			graphVolume.graph().addEdge(nodes[edge[0]], nodes[edge[1]]);
+
+		if (hasDiameters(graphVolumes)) {
+
+			setDiameters(graphVolume, nodes, diameter);
+			diameter += nodeCounts[i];
+		}
+
+		graphVolume.setResolution(resolutions[3*r], resolutions[3*r + 1], resolutions[3*r + 2]);
+		graphVolume.setOffset(offsets[3*r], offsets[3*r + 1], offsets[3*r + 2]);
+
+		graphVolumes.insert(storedIds[i], std::move(graphVolume));
+	}
+
+	return missing;
+}
+
+// the ids of all tubes that are stored completely in a packed group
+TubeIdSet readPackedIds(hid_t file, const std::string& group) {
+
+	TubeIdSet ids;
+	for (TubeId id : readPackedTable<TubeId>(file, group + "ids", numPackedTubes(file, group)))
+		ids.insert(id);
+
+	return ids;
+}
+
+} // anonymous namespace
+
 void
 Hdf5TubeStore::saveVolumes(const Volumes& volumes) {
 
@@ -17,80 +328,253 @@ Hdf5TubeStore::saveVolumes(const Volumes& volumes) {
 		const ExplicitVolume<unsigned char>& volume = p.second;
 		std::string                          name   = boost::lexical_cast<std::string>(id);
 
-		writeVolume(volume, name);
+		// tube volumes are binary masks
+		writeMask(volume, name);
 	}
 }
 
 void
 Hdf5TubeStore::saveFeatures(const Features& features) {
 
+	saveFeatures(FeatureMatrix(features));
+}
+
+void
+Hdf5TubeStore::saveFeatures(const FeatureMatrix& features) {
+
+	if (features.numTubes() == 0 || features.numFeatures() == 0)
+		return;
+
+	const hsize_t numFeatures = features.numFeatures();
+
 	_hdfFile.root();
 	_hdfFile.cd_mk("tubes");
-	_hdfFile.cd_mk("features");
 
-	for (auto& p : features) {
+	if (!_hdfFile.existsDataset(FeatureMatrixDataset))
+		createFeatureDatasets(numFeatures);
+
+	vigra::HDF5Handle matrix(
+			H5Dopen2(_file, FeatureMatrixDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature matrix");
+
+	if (numDatasetColumns(matrix) != numFeatures)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not store " << numFeatures << " features per tube, the project file contains "
+				<< numDatasetColumns(matrix) << " features per tube");
+
+	std::vector<TubeId> storedIds = readFeatureIds();
+
+	std::unordered_map<TubeId, hsize_t> storedRows;
+	for (std::size_t i = 0; i < storedIds.size(); i++)
+		storedRows[storedIds[i]] = i;
+
+	// the target row in the dataset for each row in features, features of 
+	// tubes that are stored already are overwritten in place, all others are 
+	// appended
+	Rows                rows;
+	std::vector<TubeId> newIds;
+	hsize_t             numRows = storedIds.size();
+
+	for (std::size_t i = 0; i < features.numTubes(); i++) {
+
+		TubeId id = features.getIds()[i];
+
+		auto stored = storedRows.find(id);
+
+		if (stored != storedRows.end()) {
+
+			rows.push_back(std::make_pair(stored->second, i));
 
-		TubeId                     id = p.first;
-		const std::vector<double>& f  = p.second;
+		} else {
 
-		_hdfFile.write(
-				boost::lexical_cast<std::string>(id),
-				vigra::ArrayVectorView<double>(f.size(), const_cast<double*>(&f[0])));
+			rows.push_back(std::make_pair(numRows++, i));
+			newIds.push_back(id);
+		}
 	}
+
+	std::sort(rows.begin(), rows.end());
+
+	// The rows are written before the ids, since only rows with an id are 
+	// valid. If a save is interrupted, the rows it appended are ignored and 
+	// overwritten by the next save.
+
+	if (!newIds.empty()) {
+
+		hsize_t matrixDims[2] = { numRows, numFeatures };
+
+		if (H5Dset_extent(matrix, matrixDims) < 0)
+			UTIL_THROW_EXCEPTION(
+					IOError,
+					"could not extend feature matrix");
+	}
+
+	// the dataset is written in the order of the selected rows
+	std::vector<double> buffer(rows.size()*numFeatures);
+	for (std::size_t i = 0; i < rows.size(); i++)
+		std::copy(
+				features.row(rows[i].second),
+				features.row(rows[i].second) + numFeatures,
+				buffer.begin() + i*numFeatures);
+
+	{
+		hsize_t memDims[2] = { rows.size(), numFeatures };
+
+		vigra::HDF5Handle fileSpace(H5Dget_space(matrix), &H5Sclose, "could not get dataspace");
+		vigra::HDF5Handle memSpace(H5Screate_simple(2, memDims, NULL), &H5Sclose, "could not create dataspace");
+		selectRows(fileSpace, rows, numFeatures);
+
+		if (H5Dwrite(matrix, H5T_NATIVE_DOUBLE, memSpace, fileSpace, H5P_DEFAULT, buffer.data()) < 0)
+			UTIL_THROW_EXCEPTION(
+					IOError,
+					"could not write feature matrix");
+	}
+
+	if (newIds.empty())
+		return;
+
+	hsize_t idsDims[1] = { numRows };
+
+	vigra::HDF5Handle ids(
+			H5Dopen2(_file, FeatureIdsDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature ids");
+
+	if (H5Dset_extent(ids, idsDims) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not extend feature ids");
+
+	hsize_t start = storedIds.size();
+	hsize_t count = newIds.size();
+
+	vigra::HDF5Handle fileSpace(H5Dget_space(ids), &H5Sclose, "could not get dataspace");
+	vigra::HDF5Handle memSpace(H5Screate_simple(1, &count, NULL), &H5Sclose, "could not create dataspace");
+	H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, &start, NULL, &count, NULL);
+
+	if (H5Dwrite(ids, H5T_NATIVE_INT, memSpace, fileSpace, H5P_DEFAULT, newIds.data()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not write feature ids");
 }
 
 void
 Hdf5TubeStore::saveFeatureNames(const std::vector<std::string>& names) {
 
+	if (names.empty())
+		return;
+
 	_hdfFile.root();
 	_hdfFile.cd_mk("tubes");
-	_hdfFile.cd_mk("feature_names");
 
+	if (!_hdfFile.existsDataset(FeatureMatrixDataset))
+		createFeatureDatasets(names.size());
+
+	vigra::HDF5Handle matrix(
+			H5Dopen2(_file, FeatureMatrixDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature matrix");
+
+	if (numDatasetColumns(matrix) != names.size())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"can not store " << names.size() << " feature names, the project file contains "
+				<< numDatasetColumns(matrix) << " features per tube");
+
+	// the names are stored in the order of the columns, as an attribute of 
+	// the matrix
+
+	if (H5Aexists(matrix, FeatureNamesAttribute) > 0)
+		H5Adelete(matrix, FeatureNamesAttribute);
+
+	std::vector<const char*> strings;
 	for (const std::string& name : names)
-		_hdfFile.mkdir(name);
+		strings.push_back(name.c_str());
+
+	hsize_t size = strings.size();
+
+	vigra::HDF5Handle type(H5Tcopy(H5T_C_S1), &H5Tclose, "could not create string type");
+	H5Tset_size(type, H5T_VARIABLE);
+
+	vigra::HDF5Handle space(H5Screate_simple(1, &size, NULL), &H5Sclose, "could not create dataspace");
+	vigra::HDF5Handle attribute(
+			H5Acreate2(matrix, FeatureNamesAttribute, type, space, H5P_DEFAULT, H5P_DEFAULT),
+			&H5Aclose,
+			"could not create feature names");
+
+	if (H5Awrite(attribute, type, strings.data()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not write feature names");
 }
 
-void
-Hdf5TubeStore::saveSkeletons(const Skeletons& skeletons) {
+std::vector<std::string>
+Hdf5TubeStore::retrieveFeatureNames() {
 
-	_hdfFile.root();
-	_hdfFile.cd_mk("tubes");
-	_hdfFile.cd_mk("skeletons");
+	std::vector<std::string> names;
 
-	for (auto& p : skeletons) {
+	if (!_hdfFile.existsDataset(FeatureMatrixDataset))
+		return names;
 
-		TubeId          id       = p.first;
-		const Skeleton& skeleton = p.second;
-		std::string     name     = boost::lexical_cast<std::string>(id);
+	vigra::HDF5Handle matrix(
+			H5Dopen2(_file, FeatureMatrixDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature matrix");
 
-		_hdfFile.cd_mk(name);
+	if (H5Aexists(matrix, FeatureNamesAttribute) <= 0)
+		return names;
 
-		writeGraphVolume(skeleton);
-		writeNodeMap(skeleton.graph(), skeleton.diameters(), "diameters");
+	vigra::HDF5Handle attribute(
+			H5Aopen(matrix, FeatureNamesAttribute, H5P_DEFAULT),
+			&H5Aclose,
+			"could not open feature names");
+	vigra::HDF5Handle space(H5Aget_space(attribute), &H5Sclose, "could not get dataspace");
 
-		_hdfFile.cd_up();
-	}
+	hsize_t size;
+	H5Sget_simple_extent_dims(space, &size, NULL);
+
+	vigra::HDF5Handle type(H5Tcopy(H5T_C_S1), &H5Tclose, "could not create string type");
+	H5Tset_size(type, H5T_VARIABLE);
+
+	std::vector<char*> strings(size);
+	if (H5Aread(attribute, type, strings.data()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not read feature names");
+
+	for (char* string : strings)
+		names.push_back(string);
+
+	H5Dvlen_reclaim(type, space, H5P_DEFAULT, strings.data());
+
+	return names;
 }
 
 void
-Hdf5TubeStore::saveGraphVolumes(const GraphVolumes& graphVolumes) {
+Hdf5TubeStore::saveSkeletons(const Skeletons& skeletons) {
+
+	if (skeletons.size() == 0)
+		return;
 
 	_hdfFile.root();
 	_hdfFile.cd_mk("tubes");
-	_hdfFile.cd_mk("graph_volumes");
+	_hdfFile.cd_mk("packed_skeletons");
 
-	for (auto& p : graphVolumes) {
+	writePacked(_file, PackedSkeletonsGroup, skeletons);
+}
 
-		TubeId             id          = p.first;
-		const GraphVolume& graphVolume = p.second;
-		std::string        name        = boost::lexical_cast<std::string>(id);
+void
+Hdf5TubeStore::saveGraphVolumes(const GraphVolumes& graphVolumes) {
 
-		_hdfFile.cd_mk(name);
+	if (graphVolumes.size() == 0)
+		return;
 
-		writeGraphVolume(graphVolume);
+	_hdfFile.root();
+	_hdfFile.cd_mk("tubes");
+	_hdfFile.cd_mk("packed_graph_volumes");
 
-		_hdfFile.cd_up();
-	}
+	writePacked(_file, PackedGraphVolumesGroup, graphVolumes);
 }
 
 TubeIds
@@ -105,6 +589,47 @@ Hdf5TubeStore::getTubeIds() {
 	return ids;
 }
 
+TubeIds
+Hdf5TubeStore::getSkeletonizedTubeIds() {
+
+	// skeletons are saved before graph volumes, so a tube is complete if both 
+	// have been stored
+	TubeIdSet ids =
+			readPackedIds(_file, PackedSkeletonsGroup) &
+			readPackedIds(_file, PackedGraphVolumesGroup);
+
+	// tubes stored with one group per tube in older project files
+	if (_hdfFile.existsDataset("/tubes/skeletons") && _hdfFile.existsDataset("/tubes/graph_volumes")) {
+
+		_hdfFile.cd("/tubes/graph_volumes");
+
+		for (std::string name : _hdfFile.ls()) {
+
+			// groups are listed with a trailing slash
+			if (!name.empty() && name.back() == '/')
+				name.pop_back();
+
+			// the offset is the last dataset of a graph volume, so if it 
+			// exists, the tube is complete
+			if (!_hdfFile.existsDataset(name + "/offset"))
+				continue;
+
+			if (!_hdfFile.existsDataset("/tubes/skeletons/" + name))
+				continue;
+
+			ids.insert(boost::lexical_cast<TubeId>(name));
+		}
+	}
+
+	return ids.asTubeIds();
+}
+
+void
+Hdf5TubeStore::flush() {
+
+	_hdfFile.flushToDisk();
+}
+
 void
 Hdf5TubeStore::retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry) {
 
@@ -123,16 +648,128 @@ Hdf5TubeStore::retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGe
 }
 
 void
-Hdf5TubeStore::retrieveFeatures(const TubeIds&, Features&) {
+Hdf5TubeStore::retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) {
+
+	_hdfFile.cd("/tubes/volumes");
+
+	for (TubeId id : ids) {
+
+		vigra::Shape3 shape = getVolumeShape(boost::lexical_cast<std::string>(id));
 
+		sizes.insert(id, shape[0]*shape[1]*shape[2]);
+	}
+}
+
+void
+Hdf5TubeStore::retrieveFeatures(const TubeIds& ids, Features& features) {
+
+	if (!_hdfFile.existsDataset(FeatureMatrixDataset)) {
+
+		retrieveFeaturesPerTube(ids, features);
+		return;
+	}
+
+	FeatureMatrix matrix;
+	retrieveFeatures(ids, matrix);
+	matrix.copyTo(features);
+}
+
+void
+Hdf5TubeStore::retrieveFeatures(const TubeIds& ids, FeatureMatrix& features) {
+
+	if (!_hdfFile.existsDataset(FeatureMatrixDataset)) {
+
+		// project files written before the feature matrix was introduced
+		Features perTube;
+		retrieveFeaturesPerTube(ids, perTube);
+		features = FeatureMatrix(perTube);
+		return;
+	}
+
+	vigra::HDF5Handle matrix(
+			H5Dopen2(_file, FeatureMatrixDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature matrix");
+
+	const hsize_t numFeatures = numDatasetColumns(matrix);
+
+	std::vector<TubeId> storedIds = readFeatureIds();
+
+	std::unordered_map<TubeId, hsize_t> storedRows;
+	for (std::size_t i = 0; i < storedIds.size(); i++)
+		storedRows[storedIds[i]] = i;
+
+	// the rows to read, in the order they are stored
+	Rows rows;
+	for (TubeId id : ids) {
+
+		auto stored = storedRows.find(id);
+		if (stored != storedRows.end())
+			rows.push_back(std::make_pair(stored->second, id));
+	}
+
+	std::sort(rows.begin(), rows.end());
+	rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+	features = FeatureMatrix(numFeatures);
+	features.reserve(rows.size());
+	for (auto& row : rows)
+		features.addTube(row.second);
+
+	if (rows.empty())
+		return;
+
+	hsize_t memDims[2] = { rows.size(), numFeatures };
+
+	vigra::HDF5Handle fileSpace(H5Dget_space(matrix), &H5Sclose, "could not get dataspace");
+	vigra::HDF5Handle memSpace(H5Screate_simple(2, memDims, NULL), &H5Sclose, "could not create dataspace");
+	selectRows(fileSpace, rows, numFeatures);
+
+	if (H5Dread(matrix, H5T_NATIVE_DOUBLE, memSpace, fileSpace, H5P_DEFAULT, features.data().data()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not read feature matrix");
+}
+
+void
+Hdf5TubeStore::retrieveFeaturesPerTube(const TubeIds& ids, Features& features) {
+
+	if (!_hdfFile.existsDataset("/tubes/features"))
+		return;
+
+	_hdfFile.cd("/tubes/features");
+
+	// the ids are not necessarily sorted, insert all at once
+	std::vector<std::pair<TubeId, std::vector<double>>> stored;
+
+	for (TubeId id : ids) {
+
+		std::string name = boost::lexical_cast<std::string>(id);
+
+		if (!_hdfFile.existsDataset(name))
+			continue;
+
+		vigra::ArrayVector<double> f;
+		_hdfFile.readAndResize(name, f);
+
+		stored.push_back(std::make_pair(id, std::vector<double>(f.begin(), f.end())));
+	}
+
+	features.insert(std::make_move_iterator(stored.begin()), std::make_move_iterator(stored.end()));
 }
 
 void
 Hdf5TubeStore::retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) {
 
+	TubeIds perTube = readPacked<Skeleton>(_file, PackedSkeletonsGroup, ids, skeletons);
+
+	if (perTube.size() == 0)
+		return;
+
+	// tubes stored with one group per tube in older project files
 	_hdfFile.cd("/tubes/skeletons");
 
-	for (TubeId id : ids) {
+	for (TubeId id : perTube) {
 
 		LOG_ALL(hdf5storelog) << "reading skeleton for tube " << id << std::endl;
 
@@ -152,9 +789,15 @@ Hdf5TubeStore::retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) {
 void
 Hdf5TubeStore::retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) {
 
+	TubeIds perTube = readPacked<GraphVolume>(_file, PackedGraphVolumesGroup, ids, graphVolumes);
+
+	if (perTube.size() == 0)
+		return;
+
+	// tubes stored with one group per tube in older project files
 	_hdfFile.cd("/tubes/graph_volumes");
 
-	for (TubeId id : ids) {
+	for (TubeId id : perTube) {
 
 		LOG_ALL(hdf5storelog) << "reading graph volume for tube " << id << std::endl;
 
@@ -170,6 +813,71 @@ Hdf5TubeStore::retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolum
 	}
 }
 
+void
+Hdf5TubeStore::createFeatureDatasets(std::size_t numFeatures) {
+
+	// rows per chunk, such that appending a batch of tubes touches few chunks
+	const hsize_t chunkRows = 1024;
+
+	vigra::HDF5Handle properties(H5Pcreate(H5P_DATASET_CREATE), &H5Pclose, "could not create property list");
+
+	int compression = getHdf5Compression();
+
+	// the matrix
+	{
+		hsize_t dims[2]    = { 0, numFeatures };
+		hsize_t maxDims[2] = { H5S_UNLIMITED, numFeatures };
+		hsize_t chunk[2]   = { chunkRows, numFeatures };
+
+		H5Pset_chunk(properties, 2, chunk);
+		if (compression > 0)
+			H5Pset_deflate(properties, compression);
+
+		vigra::HDF5Handle space(H5Screate_simple(2, dims, maxDims), &H5Sclose, "could not create dataspace");
+		vigra::HDF5Handle dataset(
+				H5Dcreate2(_file, FeatureMatrixDataset, H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, properties, H5P_DEFAULT),
+				&H5Dclose,
+				"could not create feature matrix");
+	}
+
+	// the ids
+	{
+		hsize_t dims[1]    = { 0 };
+		hsize_t maxDims[1] = { H5S_UNLIMITED };
+		hsize_t chunk[1]   = { chunkRows };
+
+		H5Pset_chunk(properties, 1, chunk);
+
+		vigra::HDF5Handle space(H5Screate_simple(1, dims, maxDims), &H5Sclose, "could not create dataspace");
+		vigra::HDF5Handle dataset(
+				H5Dcreate2(_file, FeatureIdsDataset, H5T_NATIVE_INT, space, H5P_DEFAULT, properties, H5P_DEFAULT),
+				&H5Dclose,
+				"could not create feature ids");
+	}
+}
+
+std::vector<TubeId>
+Hdf5TubeStore::readFeatureIds() {
+
+	vigra::HDF5Handle dataset(
+			H5Dopen2(_file, FeatureIdsDataset, H5P_DEFAULT),
+			&H5Dclose,
+			"could not open feature ids");
+	vigra::HDF5Handle space(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+
+	hsize_t size;
+	H5Sget_simple_extent_dims(space, &size, NULL);
+
+	std::vector<TubeId> ids(size);
+
+	if (size > 0 && H5Dread(dataset, H5T_NATIVE_INT, H5S_ALL, H5S_ALL, H5P_DEFAULT, ids.data()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not read feature ids");
+
+	return ids;
+}
+
 void
 Hdf5TubeStore::writeGraphVolume(const GraphVolume& graphVolume) {
 
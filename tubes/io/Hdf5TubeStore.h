@@ -2,10 +2,12 @@
 #define HOST_TUBES_IO_HDF_TUBE_STORE_H__
 
 #include <vigra/hdf5impex.hxx>
+#include <volumes/io/Hdf5File.h>
 #include <volumes/io/Hdf5VolumeReader.h>
 #include <volumes/io/Hdf5VolumeWriter.h>
 #include <tubes/io/Hdf5GraphWriter.h>
 #include <tubes/io/Hdf5GraphReader.h>
+#include <tubes/FeatureMatrix.h>
 #include "TubeStore.h"
 
 class Hdf5TubeStore :
@@ -17,14 +19,26 @@ class Hdf5TubeStore :
 
 public:
 
-	Hdf5TubeStore(std::string projectFile) :
+	/**
+	 * Open the tube store in the given project file. A read-only store can be 
+	 * opened by several processes at the same time. To read from several 
+	 * threads, wrap the store in a ConcurrentTubeStore.
+	 */
+	Hdf5TubeStore(std::string projectFile, bool readOnly = false) :
 		Hdf5VolumeReader(_hdfFile),
 		Hdf5VolumeWriter(_hdfFile),
 		Hdf5GraphReader(_hdfFile),
 		Hdf5GraphWriter(_hdfFile),
-		_hdfFile(
-				projectFile,
-				vigra::HDF5File::OpenMode::ReadWrite) {}
+		_file(openHdf5File(projectFile, readOnly)),
+		_hdfFile(_file, "", readOnly) {}
+
+	/**
+	 * The HDF5 file of the project, for accesses not covered by the tube store 
+	 * (like the completion marks of processing stages, see 
+	 * setHdf5StageComplete()). Use it only from the thread that uses the 
+	 * store.
+	 */
+	hid_t getFile() { return _file; }
 
 	/**
 	 * Store the given tube volumes.
@@ -32,22 +46,44 @@ public:
 	 void saveVolumes(const Volumes& volumes) override;
 
 	/**
-	 * Store the given tube features.
+	 * Store the given tube features. All tubes have to have the same number of 
+	 * features. Features of tubes that are stored already are replaced.
 	 */
 	 void saveFeatures(const Features& features) override;
 
 	/**
-	 * Store the names of the features.
+	 * Store the given feature matrix. Features are stored as a single 2D 
+	 * dataset with one row per tube, together with a dataset of the tube ids 
+	 * of the rows.
+	 */
+	void saveFeatures(const FeatureMatrix& features);
+
+	/**
+	 * Store the names of the features, in the order of the columns of the 
+	 * feature matrix.
 	 */
 	 void saveFeatureNames(const std::vector<std::string>& names) override;
 
 	/**
-	 * Store the given tube skeletons.
+	 * Get the names of the features, in the order of the columns of the 
+	 * feature matrix. Empty, if no names were stored.
+	 */
+	std::vector<std::string> retrieveFeatureNames();
+
+	/**
+	 * Store the given tube skeletons. The skeletons are appended to packed 
+	 * datasets that hold the nodes, edges, and node maps of all tubes, such 
+	 * that saving and retrieving many skeletons needs only a few HDF5 calls.
+	 *
+	 * Skeletons of tubes that are stored already replace the old ones when 
+	 * retrieved, but the old ones stay in the file: every re-save makes the 
+	 * project file larger.
 	 */
 	void saveSkeletons(const Skeletons& skeletons) override;
 
 	/**
-	 * Store the given tube graph volumes.
+	 * Store the given tube graph volumes, in packed datasets like the 
+	 * skeletons.
 	 */
 	void saveGraphVolumes(const GraphVolumes& graphVolumes) override;
 
@@ -56,6 +92,17 @@ public:
 	 */
 	 TubeIds getTubeIds() override;
 
+	/**
+	 * Get the ids of all tubes for which a skeleton and a graph volume have 
+	 * been stored completely.
+	 */
+	TubeIds getSkeletonizedTubeIds() override;
+
+	/**
+	 * Flush the project file to disk.
+	 */
+	void flush() override;
+
 	/**
 	 * Get the volumes for the given tube ids and store them in the given 
 	 * property map. If onlyGeometry is true, only the bounding boxes and voxel 
@@ -63,12 +110,24 @@ public:
 	 */
 	 void retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry = false) override;
 
+	/**
+	 * Get the number of voxels of the volumes for the given tube ids, without 
+	 * reading the volumes.
+	 */
+	void retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) override;
+
 	/**
 	 * Get the features for the given tube ids and store them in the given 
 	 * property map.
 	 */
 	 void retrieveFeatures(const TubeIds& ids, Features& features) override;
 
+	/**
+	 * Get the features for the given tube ids as a feature matrix. Only the 
+	 * rows of the requested tubes are read.
+	 */
+	void retrieveFeatures(const TubeIds& ids, FeatureMatrix& features);
+
 	/**
 	 * Get the skeletons for the given tube ids and store them in the given 
 	 * property map.
@@ -76,7 +135,7 @@ public:
 	void retrieveSkeletons(const TubeIds& ids, Skeletons& skeletons) override;
 
 	/**
-	 * Get the skeletons for the given tube ids and store them in the given 
+	 * Get the graph volumes for the given tube ids and store them in the given 
 	 * property map.
 	 */
 	void retrieveGraphVolumes(const TubeIds& ids, GraphVolumes& graphVolumes) override;
@@ -84,22 +143,20 @@ public:
 private:
 
 	/**
-	 * Converts Position objects into array-like objects for HDF5 storage.
+	 * Converts Position objects from and to arrays for HDF5 storage.
 	 */
 	struct PositionConverter {
 
 		typedef float    ArrayValueType;
 		static const int ArraySize = 3;
 
-		vigra::ArrayVector<float> operator()(const Skeleton::Position& pos) const {
+		void operator()(const Skeleton::Position& pos, float* array) const {
 
-			vigra::ArrayVector<float> array(3);
 			for (int i = 0; i < 3; i++)
 				array[i] = pos[i];
-			return array;
 		}
 
-		Skeleton::Position operator()(const vigra::ArrayVectorView<float>& array) const {
+		Skeleton::Position operator()(const float* array) const {
 
 			Skeleton::Position pos;
 			for (int i = 0; i < 3; i++)
@@ -113,7 +170,17 @@ private:
 	void writeGraphVolume(const GraphVolume& graphVolume);
 	void readGraphVolume(GraphVolume& graphVolume);
 
-	vigra::HDF5File _hdfFile;
+	// create the empty, extendible feature matrix and id datasets
+	void createFeatureDatasets(std::size_t numFeatures);
+
+	// the tube ids of the rows of the feature matrix
+	std::vector<TubeId> readFeatureIds();
+
+	// read features stored with one dataset per tube
+	void retrieveFeaturesPerTube(const TubeIds& ids, Features& features);
+
+	vigra::HDF5HandleShared _file;
+	vigra::HDF5File         _hdfFile;
 };
 
 #endif // HOST_TUBES_IO_HDF_TUBE_STORE_H__
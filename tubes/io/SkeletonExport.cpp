@@ -0,0 +1,79 @@
+#include <boost/lexical_cast.hpp>
+#include "SkeletonExport.h"
+
+void
+exportSkeleton(const Skeleton& skeleton, std::ostream& out, bool vtk) {
+
+	if (vtk) {
+
+		out << "# vtk DataFile Version 3.0" << std::endl;
+		out << "vtk output" << std::endl;
+		out << "ASCII" << std::endl;
+		out << "DATASET UNDIRECTED_GRAPH" << std::endl;
+	}
+
+	int numNodes = 0;
+	int numEdges = 0;
+	for (Skeleton::Graph::NodeIt node(skeleton.graph()); node != lemon::INVALID; ++node)
+		numNodes++;
+	for (Skeleton::Graph::EdgeIt edge(skeleton.graph()); edge != lemon::INVALID; ++edge)
+		numEdges++;
+
+	// nodes (number of)
+
+	if (vtk)
+		out << "POINTS " << numNodes << " float" << std::endl;
+	else
+		out << numNodes << std::endl;
+
+	// node positions (node x y z)
+	for (int nodeId = 0; nodeId < numNodes; nodeId++) {
+
+		Skeleton::Graph::Node node = skeleton.graph().nodeFromId(nodeId);
+
+		if (!vtk)
+			out
+					<< skeleton.graph().id(node) << "\t";
+
+		util::point<float, 3> pos = skeleton.positions()[node];
+		pos = pos*skeleton.getResolution() + skeleton.getOffset();
+
+		out
+				<< pos.x() << " "
+				<< pos.y() << " "
+				<< pos.z() << std::endl;
+	}
+
+	if (vtk) {
+
+		out << "VERTICES " << numNodes << std::endl;
+		out << "EDGES " << numEdges << std::endl;
+	}
+
+	// edges (pairs of nodes)
+
+	for (Skeleton::Graph::EdgeIt edge(skeleton.graph()); edge != lemon::INVALID; ++edge)
+		out
+				<< skeleton.graph().id(skeleton.graph().u(edge)) << " "
+				<< skeleton.graph().id(skeleton.graph().v(edge)) << std::endl;
+
+	// node diameters (node d)
+
+	if (vtk) {
+
+		out << "VERTEX_DATA " << numNodes << std::endl;
+		out << "FIELD FieldData 1" << std::endl;
+		out << "diameters 1 " << numNodes << " double" << std::endl;
+	}
+	for (int nodeId = 0; nodeId < numNodes; nodeId++) {
+
+		Skeleton::Graph::Node node = skeleton.graph().nodeFromId(nodeId);
+		out << skeleton.diameters()[node] << std::endl;
+	}
+}
+
+std::string
+getSkeletonExportFilename(TubeId id, bool vtk) {
+
+	return std::string("skeleton_") + boost::lexical_cast<std::string>(id) + (vtk ? ".vtk" : ".txt");
+}
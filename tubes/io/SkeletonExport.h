@@ -0,0 +1,23 @@
+#ifndef HOST_TUBES_IO_SKELETON_EXPORT_H__
+#define HOST_TUBES_IO_SKELETON_EXPORT_H__
+
+#include <string>
+#include <ostream>
+#include <imageprocessing/Skeleton.h>
+#include <tubes/TubeId.h>
+
+/**
+ * Write a skeleton in world coordinates to the given stream, either as a vtk 
+ * ASCII graph, or as a simple text file (the number of nodes, one line 'id x y 
+ * z' per node, one line 'u v' per edge, and one line per node diameter).
+ */
+void exportSkeleton(const Skeleton& skeleton, std::ostream& out, bool vtk);
+
+/**
+ * The name of the file to export the skeleton of the given tube to, 
+ * 'skeleton_<id>.vtk' or 'skeleton_<id>.txt'.
+ */
+std::string getSkeletonExportFilename(TubeId id, bool vtk);
+
+#endif // HOST_TUBES_IO_SKELETON_EXPORT_H__
+
@@ -43,6 +43,18 @@ public:
 	 */
 	virtual TubeIds getTubeIds() = 0;
 
+	/**
+	 * Get the ids of all tubes for which a skeleton and a graph volume have 
+	 * been stored completely.
+	 */
+	virtual TubeIds getSkeletonizedTubeIds() = 0;
+
+	/**
+	 * Write everything that was saved so far to persistent storage, such that 
+	 * it survives a crash of the process.
+	 */
+	virtual void flush() = 0;
+
 	/**
 	 * Get the volumes for the given tube ids and store them in the given 
 	 * property map. If onlyGeometry is true, only the bounding boxes and voxel 
@@ -50,6 +62,12 @@ public:
 	 */
 	virtual void retrieveVolumes(const TubeIds& ids, Volumes& volumes, bool onlyGeometry = false) = 0;
 
+	/**
+	 * Get the number of voxels of the volumes for the given tube ids, without 
+	 * reading the volumes.
+	 */
+	virtual void retrieveVolumeSizes(const TubeIds& ids, VolumeSizes& sizes) = 0;
+
 	/**
 	 * Get the features for the given tube ids and store them in the given 
 	 * property map.
@@ -1,11 +1,55 @@
 #include "ExtractLabels.h"
-#include <vigra/multi_labeling.hxx>
+#include <limits>
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
 #include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include "ParallelFor.h"
 
 util::ProgramOption optionKLargestComponents(
 		util::_long_name        = "kLargestComponents",
 		util::_description_text = "When extracting labels from a black/white image, only consider the k largest connected components.");
 
+namespace {
+
+// the parent of background voxels
+const uint32_t Background = std::numeric_limits<uint32_t>::max();
+
+// find the root of a voxel, halving the path on the way
+uint32_t findRoot(std::vector<uint32_t>& parents, uint32_t i) {
+
+	while (parents[i] != i) {
+
+		parents[i] = parents[parents[i]];
+		i = parents[i];
+	}
+
+	return i;
+}
+
+// merge the trees of two voxels, the smaller index becomes the root, such that
+// every voxel's parent has a smaller or equal index; returns the root that got
+// a new parent, or Background if both voxels were in the same tree already
+uint32_t merge(std::vector<uint32_t>& parents, uint32_t i, uint32_t j) {
+
+	i = findRoot(parents, i);
+	j = findRoot(parents, j);
+
+	if (i == j)
+		return Background;
+
+	if (i > j)
+		std::swap(i, j);
+
+	parents[j] = i;
+
+	return j;
+}
+
+} // anonymous namespace
+
 ExtractLabels::ExtractLabels() {
 
 	registerInput(_stack, "stack");
@@ -19,24 +63,153 @@ ExtractLabels::updateOutputs() {
 	unsigned int height = _stack->height();
 	unsigned int depth  = _stack->size();
 
+	const std::size_t sectionSize = static_cast<std::size_t>(width)*height;
+	const std::size_t size        = sectionSize*depth;
+
+	if (size >= Background)
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"label stacks with more than " << Background << " voxels are not supported");
+
+	std::vector<const vigra::MultiArray<2, float>*> sections;
+	foreach (boost::shared_ptr<Image> image, *_stack)
+		sections.push_back(image.get());
+
+	// Voxels with the same, non-zero value form a component if they are
+	// 6-connected (like vigra::labelMultiArrayWithBackground). Components are
+	// found with a union-find over the voxel indices, in parallel for slabs of
+	// sections, and merged across the slab boundaries afterwards. The root of
+	// each component is its first voxel in scan order.
+
+	std::vector<uint32_t> parents(size);
+
+	std::size_t numSlabs  = std::max<std::size_t>(1, std::min<std::size_t>(depth, 4*getNumThreads()));
+	std::size_t slabDepth = std::max<std::size_t>(1, (depth + numSlabs - 1)/numSlabs);
+	numSlabs = (depth + slabDepth - 1)/slabDepth;
+
+	parallelFor(0, numSlabs, [&](std::size_t s) {
+
+		unsigned int begin = s*slabDepth;
+		unsigned int end   = std::min<unsigned int>(begin + slabDepth, depth);
+
+		for (unsigned int z = begin; z < end; z++)
+		for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++) {
+
+			uint32_t i     = z*sectionSize + y*width + x;
+			float    value = (*sections[z])(x, y);
+
+			if (value == 0) {
+
+				parents[i] = Background;
+				continue;
+			}
+
+			parents[i] = i;
+
+			if (x > 0 && (*sections[z])(x - 1, y) == value)
+				merge(parents, i, i - 1);
+			if (y > 0 && (*sections[z])(x, y - 1) == value)
+				merge(parents, i, i - width);
+			if (z > begin && (*sections[z - 1])(x, y) == value)
+				merge(parents, i, i - sectionSize);
+		}
+
+		// point every voxel to the root of its slab tree, parents come first
+		for (uint32_t i = begin*sectionSize; i < end*sectionSize; i++)
+			if (parents[i] != Background)
+				parents[i] = parents[parents[i]];
+	});
+
+	// merge the slab trees across slab boundaries, remembering the roots that
+	// got a new parent
+	std::vector<uint32_t> merged;
+
+	for (std::size_t s = 1; s < numSlabs; s++) {
+
+		unsigned int z = s*slabDepth;
+
+		for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++) {
+
+			uint32_t i     = z*sectionSize + y*width + x;
+			float    value = (*sections[z])(x, y);
+
+			if (value == 0 || (*sections[z - 1])(x, y) != value)
+				continue;
+
+			uint32_t child = merge(parents, i, i - sectionSize);
+			if (child != Background)
+				merged.push_back(child);
+		}
+	}
+
+	// point the merged slab roots to their final roots, in increasing order
+	// such that the parent of each is final already
+	std::sort(merged.begin(), merged.end());
+	for (uint32_t root : merged)
+		parents[root] = parents[parents[root]];
+
+	// Point every voxel to its final root, find the roots, and count the
+	// voxels per root. Only voxels that are not slab roots are changed, slab
+	// roots are final already and read by other threads.
+
+	bool countSizes = optionKLargestComponents;
+
+	std::vector<std::vector<uint32_t>>                     slabRoots(numSlabs);
+	std::vector<std::unordered_map<uint32_t, std::size_t>> slabSizes(numSlabs);
+
+	parallelFor(0, numSlabs, [&](std::size_t s) {
+
+		uint32_t begin = s*slabDepth*sectionSize;
+		uint32_t end   = std::min<std::size_t>((s + 1)*slabDepth, depth)*sectionSize;
+
+		for (uint32_t i = begin; i < end; i++) {
+
+			if (parents[i] == Background)
+				continue;
+
+			uint32_t root = parents[parents[i]];
+
+			if (parents[i] != root)
+				parents[i] = root;
+
+			if (root == i)
+				slabRoots[s].push_back(i);
+
+			if (countSizes)
+				slabSizes[s][root]++;
+		}
+	});
+
+	// the label of each component is one plus the position of its root
+	std::vector<std::size_t> slabOffsets(numSlabs + 1, 0);
+	for (std::size_t s = 0; s < numSlabs; s++)
+		slabOffsets[s + 1] = slabOffsets[s] + slabRoots[s].size();
+
+	int numComponents = slabOffsets[numSlabs];
+
+	std::cout << "found " << numComponents << " connected components" << std::endl;
+
 	_labelStack = new ImageStack();
 	for (unsigned int d = 0; d < depth; d++)
 		_labelStack->add(boost::make_shared<Image>(width, height));
 
-	vigra::MultiArray<3, float> gtVolume(vigra::Shape3(width, height, depth));
-	unsigned int z = 0;
-	foreach (boost::shared_ptr<Image> image, *_stack) {
+	std::vector<vigra::MultiArray<2, float>*> labelSections;
+	foreach (boost::shared_ptr<Image> image, *_labelStack)
+		labelSections.push_back(image.get());
 
-		gtVolume.bind<2>(z) = *image;
-		z++;
-	}
+	// the label of a voxel, stored at the root of each component first
+	auto labelAt = [&](uint32_t i) -> float& {
 
-	vigra::MultiArray<3, float> gtLabels(vigra::Shape3(width, height, depth));
-	int numComponents = vigra::labelMultiArrayWithBackground(
-			gtVolume,
-			gtLabels);
+		return (*labelSections[i/sectionSize])(i%width, (i%sectionSize)/width);
+	};
 
-	std::cout << "found " << numComponents << " connected components" << std::endl;
+	parallelFor(0, numSlabs, [&](std::size_t s) {
+
+		for (std::size_t r = 0; r < slabRoots[s].size(); r++)
+			labelAt(slabRoots[s][r]) = slabOffsets[s] + r + 1;
+	});
 
 	if (optionKLargestComponents) {
 
@@ -45,34 +218,57 @@ ExtractLabels::updateOutputs() {
 		// sizes: 0-indexed components
 		std::vector<std::pair<size_t,int>> sizes(numComponents, std::make_pair(0, 0));
 
-		for (auto& v : gtLabels)
-			if (v != 0)
-				sizes[v - 1].first++;
+		// the component of a root, looked up once per root and slab
+		auto componentOf = [&](uint32_t root) {
+
+			std::size_t            s     = root/(slabDepth*sectionSize);
+			std::vector<uint32_t>& roots = slabRoots[s];
+
+			return slabOffsets[s] + (std::lower_bound(roots.begin(), roots.end(), root) - roots.begin());
+		};
+
+		for (auto& slab : slabSizes)
+			for (auto& p : slab)
+				sizes[componentOf(p.first)].first += p.second;
 		for (int i = 0; i < numComponents; i++)
 			sizes[i].second = i;
 		std::sort(sizes.rbegin(), sizes.rend());
 
 		// selected: 0-indexed flag per component
-		std::vector<bool> selected(numComponents, false);
+		std::vector<bool> selected(numComponents);
+
 		for (int i = 0; i < numComponents; i++) {
 
 			if (i < k)
 				std::cout << "accepting component " << (sizes[i].second + 1) << std::endl;
 			selected[sizes[i].second] = (i < k);
 		}
-		for (auto& v : gtLabels)
-			if (v > 0 && !selected[v - 1])
-				v = 0;
 
 		std::cout << "selected " << std::min(k, numComponents) << " components" << std::endl;
+
+		// unselected components get the background label
+		for (std::size_t s = 0; s < numSlabs; s++)
+			for (std::size_t r = 0; r < slabRoots[s].size(); r++)
+				if (!selected[slabOffsets[s] + r])
+					labelAt(slabRoots[s][r]) = 0;
 	}
 
-	z = 0;
-	foreach (boost::shared_ptr<Image> image, *_labelStack) {
+	// every other voxel gets the label of its root, which are not changed 
+	// anymore
+	parallelFor(0, depth, [&](std::size_t z) {
 
-		static_cast<vigra::MultiArray<2, float>& >(*image) = gtLabels.bind<2>(z);
-		z++;
-	}
+		for (unsigned int y = 0; y < height; y++)
+		for (unsigned int x = 0; x < width; x++) {
+
+			uint32_t i    = z*sectionSize + y*width + x;
+			uint32_t root = parents[i];
+
+			if (root == Background)
+				(*labelSections[z])(x, y) = 0;
+			else if (root != i)
+				(*labelSections[z])(x, y) = labelAt(root);
+		}
+	});
 
 	_labelStack->setResolution(_stack->getResolution());
 	_labelStack->setOffset(_stack->getOffset());
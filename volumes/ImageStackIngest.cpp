@@ -0,0 +1,240 @@
+#include <mutex>
+#include <ctime>
+#include <sstream>
+#include <limits>
+#include <algorithm>
+#include <boost/filesystem.hpp>
+#include <vigra/impex.hxx>
+#include <util/Logger.h>
+#include <util/exceptions.h>
+#include <volumes/io/Hdf5File.h>
+#include <volumes/io/Hdf5VolumeStore.h>
+#include "ParallelFor.h"
+#include "VolumePyramid.h"
+#include "ImageStackIngest.h"
+
+logger::LogChannel imagestackingestlog("imagestackingestlog", "[ImageStackIngest] ");
+
+ImageStackIngest::ImageStackIngest(const std::string& directory) {
+
+	boost::filesystem::path dir(directory);
+
+	if (!boost::filesystem::is_directory(dir))
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				directory << " is not a directory");
+
+	for (boost::filesystem::directory_iterator i(dir); i != boost::filesystem::directory_iterator(); ++i)
+		if (boost::filesystem::is_regular_file(*i) && vigra::isImage(i->path().string().c_str()))
+			_files.push_back(i->path().string());
+
+	if (_files.empty())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"no images found in " << directory);
+
+	std::sort(_files.begin(), _files.end());
+
+	vigra::ImageImportInfo info(_files[0].c_str());
+	_shape = vigra::Shape3(info.width(), info.height(), _files.size());
+
+	LOG_DEBUG(imagestackingestlog)
+			<< "found " << _files.size() << " images of size "
+			<< info.width() << "x" << info.height() << " in " << directory << std::endl;
+}
+
+void
+ImageStackIngest::ingestIntensities(VolumeStore& store, int pyramidLevels) {
+
+	std::pair<float, float> minMax = getMinMax();
+
+	float min   = minMax.first;
+	float scale = (minMax.second > minMax.first ? 1.0/(minMax.second - minMax.first) : 1.0);
+
+	LOG_DEBUG(imagestackingestlog)
+			<< "normalizing intensities in [" << minMax.first << ", " << minMax.second << "]" << std::endl;
+
+	store.createIntensities(
+			_shape,
+			util::point<float,3>(1, 1, 1),
+			util::point<float,3>(0, 0, 0));
+
+	VolumePyramidBuilder<float> pyramid(
+			store,
+			_shape,
+			util::point<float,3>(1, 1, 1),
+			util::point<float,3>(0, 0, 0),
+			pyramidLevels);
+
+	vigra::MultiArray<3, float> slab;
+
+	for (std::size_t begin = 0; begin < _files.size(); begin += getSlabDepth()) {
+
+		std::size_t end = std::min(begin + getSlabDepth(), _files.size());
+
+		readSlab(begin, end, slab, [min, scale](float v) { return (v - min)*scale; });
+
+		store.saveIntensities(vigra::Shape3(0, 0, begin), slab);
+		pyramid.addSlab(slab);
+	}
+
+	pyramid.finish();
+}
+
+void
+ImageStackIngest::ingestLabels(VolumeStore& store, int pyramidLevels) {
+
+	store.createLabels(
+			_shape,
+			util::point<float,3>(1, 1, 1),
+			util::point<float,3>(0, 0, 0));
+
+	VolumePyramidBuilder<int> pyramid(
+			store,
+			_shape,
+			util::point<float,3>(1, 1, 1),
+			util::point<float,3>(0, 0, 0),
+			pyramidLevels);
+
+	vigra::MultiArray<3, int> slab;
+
+	for (std::size_t begin = 0; begin < _files.size(); begin += getSlabDepth()) {
+
+		std::size_t end = std::min(begin + getSlabDepth(), _files.size());
+
+		readSlab(begin, end, slab, [](float v) { return static_cast<int>(v); });
+
+		store.saveLabels(vigra::Shape3(0, 0, begin), slab);
+		pyramid.addSlab(slab);
+	}
+
+	pyramid.finish();
+}
+
+template <typename ValueType, typename F>
+void
+ImageStackIngest::readSlab(std::size_t begin, std::size_t end, vigra::MultiArray<3, ValueType>& slab, F f) {
+
+	vigra::Shape3 shape(_shape[0], _shape[1], end - begin);
+	if (slab.shape() != shape)
+		slab.reshape(shape);
+
+	parallelFor(begin, end, [&](std::size_t z) {
+
+		vigra::MultiArray<2, float> slice;
+		readSlice(z, slice);
+
+		vigra::MultiArrayView<2, ValueType> target = slab.template bind<2>(z - begin);
+
+		auto i = target.begin();
+		for (float v : slice)
+			*i++ = f(v);
+	});
+}
+
+void
+ImageStackIngest::readSlice(std::size_t z, vigra::MultiArray<2, float>& slice) {
+
+	vigra::ImageImportInfo info(_files[z].c_str());
+
+	if (info.width() != _shape[0] || info.height() != _shape[1])
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"image " << _files[z] << " has size " << info.width() << "x" << info.height()
+				<< ", expected " << _shape[0] << "x" << _shape[1]);
+
+	slice.reshape(info.shape());
+	vigra::importImage(info, slice);
+}
+
+std::pair<float, float>
+ImageStackIngest::getMinMax() {
+
+	float      min = std::numeric_limits<float>::max();
+	float      max = std::numeric_limits<float>::lowest();
+	std::mutex mutex;
+
+	parallelFor(0, _files.size(), [&](std::size_t z) {
+
+		vigra::MultiArray<2, float> slice;
+		readSlice(z, slice);
+
+		auto minMax = std::minmax_element(slice.begin(), slice.end());
+
+		std::lock_guard<std::mutex> lock(mutex);
+		min = std::min(min, *minMax.first);
+		max = std::max(max, *minMax.second);
+	});
+
+	return std::make_pair(min, max);
+}
+
+std::size_t
+ImageStackIngest::getSlabDepth() {
+
+	// whole chunks, such that each chunk is compressed only once
+	int depth = getHdf5ChunkShape()[2];
+
+	return (depth > 0 ? depth : 64);
+}
+
+namespace {
+
+// the time of the last change to the given directory or any file in it, 0 if 
+// it does not exist
+std::time_t getLastWriteTime(const std::string& directory) {
+
+	if (!boost::filesystem::exists(directory))
+		return 0;
+
+	std::time_t last = boost::filesystem::last_write_time(directory);
+
+	boost::filesystem::directory_iterator end;
+	for (boost::filesystem::directory_iterator i(directory); i != end; i++)
+		last = std::max(last, boost::filesystem::last_write_time(*i));
+
+	return last;
+}
+
+} // anonymous namespace
+
+std::string
+getImageStacksStamp(const std::string& intensityDirectory, const std::string& labelDirectory) {
+
+	std::stringstream stamp;
+	stamp
+			<< boost::filesystem::absolute(intensityDirectory).string() << ":" << getLastWriteTime(intensityDirectory) << ";"
+			<< boost::filesystem::absolute(labelDirectory).string()     << ":" << getLastWriteTime(labelDirectory);
+
+	return stamp.str();
+}
+
+void
+createProjectVolumes(
+		const std::string& projectFile,
+		const std::string& intensityDirectory,
+		const std::string& labelDirectory) {
+
+	// taken before reading, such that changes while reading are noticed next 
+	// time
+	std::string stamp = getImageStacksStamp(intensityDirectory, labelDirectory);
+
+	ImageStackIngest intensityIngest(intensityDirectory);
+	ImageStackIngest labelIngest(labelDirectory);
+
+	if (labelIngest.getShape() != intensityIngest.getShape())
+		UTIL_THROW_EXCEPTION(
+				UsageError,
+				"intensity and label stacks have different sizes");
+
+	boost::filesystem::remove(projectFile);
+
+	{
+		Hdf5VolumeStore volumeStore(projectFile);
+
+		labelIngest.ingestLabels(volumeStore, getNumPyramidLevels());
+		intensityIngest.ingestIntensities(volumeStore, getNumPyramidLevels());
+	}
+
+	setHdf5StageComplete(openHdf5File(projectFile), "volumes", stamp);
+}
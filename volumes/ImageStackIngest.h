@@ -0,0 +1,84 @@
+#ifndef HOST_VOLUMES_IMAGE_STACK_INGEST_H__
+#define HOST_VOLUMES_IMAGE_STACK_INGEST_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <vigra/multi_array.hxx>
+#include <volumes/io/VolumeStore.h>
+
+/**
+ * Reads a directory of image slices into a volume store, one slab of slices 
+ * at a time, without creating the whole volume in memory. The slices of a 
+ * slab are decoded in parallel. Slabs are as deep as the chunks of the 
+ * project file (see program option hdf5ChunkSize).
+ */
+class ImageStackIngest {
+
+public:
+
+	/**
+	 * Create an ingest for the images in the given directory. The images are 
+	 * read in the order of their file names.
+	 */
+	ImageStackIngest(const std::string& directory);
+
+	/**
+	 * The shape of the volume in voxels.
+	 */
+	const vigra::Shape3& getShape() const { return _shape; }
+
+	/**
+	 * Store the images as the intensity volume, normalized to [0,1] with the 
+	 * minimal and maximal value of all images. The given number of pyramid 
+	 * levels is built from the same slabs (see VolumePyramidBuilder).
+	 */
+	void ingestIntensities(VolumeStore& store, int pyramidLevels = 0);
+
+	/**
+	 * Store the images as the label volume, and the given number of pyramid 
+	 * levels.
+	 */
+	void ingestLabels(VolumeStore& store, int pyramidLevels = 0);
+
+private:
+
+	// read the slices [begin, end) into slab, converting each value with f
+	template <typename ValueType, typename F>
+	void readSlab(std::size_t begin, std::size_t end, vigra::MultiArray<3, ValueType>& slab, F f);
+
+	// read a single slice
+	void readSlice(std::size_t z, vigra::MultiArray<2, float>& slice);
+
+	// the minimal and maximal value of all slices
+	std::pair<float, float> getMinMax();
+
+	// the number of slices to read at a time
+	std::size_t getSlabDepth();
+
+	std::vector<std::string> _files;
+
+	vigra::Shape3 _shape;
+};
+
+/**
+ * A stamp of the image stacks in the given directories, from their paths and 
+ * the time of the last change to them or any file in them. Changes whenever 
+ * an image is added, removed, or modified.
+ */
+std::string getImageStacksStamp(const std::string& intensityDirectory, const std::string& labelDirectory);
+
+/**
+ * Create a project file with the intensity and label volumes of the image 
+ * stacks in the given directories, and the number of pyramid levels given by 
+ * program option pyramidLevels. An existing project file is replaced. When 
+ * done, the stage "volumes" is marked complete with the stamp of the image 
+ * stacks (see setHdf5StageComplete()).
+ */
+void createProjectVolumes(
+		const std::string& projectFile,
+		const std::string& intensityDirectory,
+		const std::string& labelDirectory);
+
+#endif // HOST_VOLUMES_IMAGE_STACK_INGEST_H__
+
@@ -0,0 +1,18 @@
+#include <util/ProgramOptions.h>
+#include "ParallelFor.h"
+
+util::ProgramOption optionNumThreads(
+		util::_long_name        = "numThreads",
+		util::_description_text = "The number of threads to use for processing volumes and tubes. 0 uses one thread per core.",
+		util::_default_value    = 0);
+
+unsigned int
+getNumThreads() {
+
+	unsigned int numThreads = optionNumThreads.as<unsigned int>();
+
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	return numThreads;
+}
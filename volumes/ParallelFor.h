@@ -0,0 +1,75 @@
+#ifndef HOST_VOLUMES_PARALLEL_FOR_H__
+#define HOST_VOLUMES_PARALLEL_FOR_H__
+
+#include <thread>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <exception>
+
+/**
+ * The number of threads to use for parallel loops over volumes and tubes, as 
+ * set by the program option numThreads. Defaults to the number of cores.
+ */
+unsigned int getNumThreads();
+
+/**
+ * Call f(i) for each i in [begin, end) on getNumThreads() threads. The indices 
+ * are handed out one at a time, such that work items of different sizes are 
+ * balanced over the threads. The first exception thrown by f stops the loop 
+ * and is rethrown in the calling thread.
+ */
+template <typename F>
+void parallelFor(std::size_t begin, std::size_t end, F f) {
+
+	if (begin >= end)
+		return;
+
+	unsigned int numThreads = std::min<std::size_t>(getNumThreads(), end - begin);
+
+	if (numThreads <= 1) {
+
+		for (std::size_t i = begin; i < end; i++)
+			f(i);
+
+		return;
+	}
+
+	std::atomic<std::size_t> next(begin);
+	std::exception_ptr       error;
+	std::mutex               errorMutex;
+
+	auto work = [&]() {
+
+		std::size_t i;
+		while ((i = next++) < end) {
+
+			try {
+
+				f(i);
+
+			} catch (...) {
+
+				std::lock_guard<std::mutex> lock(errorMutex);
+				if (!error)
+					error = std::current_exception();
+
+				next = end;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (unsigned int t = 0; t < numThreads; t++)
+		threads.push_back(std::thread(work));
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	if (error)
+		std::rethrow_exception(error);
+}
+
+#endif // HOST_VOLUMES_PARALLEL_FOR_H__
+
@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <util/Logger.h>
+#include <util/ProgramOptions.h>
+#include <volumes/io/Hdf5File.h>
+#include "ParallelFor.h"
+#include "VolumePyramid.h"
+
+util::ProgramOption optionPyramidLevels(
+		util::_long_name        = "pyramidLevels",
+		util::_description_text = "The number of downsampled levels of the intensity and label volumes to store in the project "
+		                          "file, each with half the resolution of the previous one.",
+		util::_default_value    = 3);
+
+logger::LogChannel volumepyramidlog("volumepyramidlog", "[VolumePyramid] ");
+
+namespace {
+
+// call f(x, y, z) for each voxel of the downsampled volume, in parallel over 
+// sections
+template <typename ValueType, typename F>
+void forEachVoxel(const vigra::MultiArrayView<3, ValueType>& downsampled, F f) {
+
+	parallelFor(0, downsampled.shape(2), [&](std::size_t z) {
+
+		for (int y = 0; y < downsampled.shape(1); y++)
+		for (int x = 0; x < downsampled.shape(0); x++)
+			f(x, y, z);
+	});
+}
+
+// downsample data into target, which has half the size, by averaging blocks 
+// of 2x2x2 voxels
+void downsampleBlock(const vigra::MultiArrayView<3, float>& data, vigra::MultiArrayView<3, float> target) {
+
+	forEachVoxel(target, [&](int x, int y, int z) {
+
+		float sum = 0;
+		int   num = 0;
+
+		for (int dz = 2*z; dz < std::min<int>(2*z + 2, data.shape(2)); dz++)
+		for (int dy = 2*y; dy < std::min<int>(2*y + 2, data.shape(1)); dy++)
+		for (int dx = 2*x; dx < std::min<int>(2*x + 2, data.shape(0)); dx++) {
+
+			sum += data(dx, dy, dz);
+			num++;
+		}
+
+		target(x, y, z) = sum/num;
+	});
+}
+
+// downsample data into target, which has half the size, by taking the most 
+// frequent label of blocks of 2x2x2 voxels
+void downsampleBlock(const vigra::MultiArrayView<3, int>& data, vigra::MultiArrayView<3, int> target) {
+
+	forEachVoxel(target, [&](int x, int y, int z) {
+
+		int block[8];
+		int num = 0;
+
+		for (int dz = 2*z; dz < std::min<int>(2*z + 2, data.shape(2)); dz++)
+		for (int dy = 2*y; dy < std::min<int>(2*y + 2, data.shape(1)); dy++)
+		for (int dx = 2*x; dx < std::min<int>(2*x + 2, data.shape(0)); dx++)
+			block[num++] = data(dx, dy, dz);
+
+		std::sort(block, block + num);
+
+		// the longest run in the sorted block, the last one wins ties
+		int mode      = block[0];
+		int modeCount = 0;
+		for (int begin = 0, end; begin < num; begin = end) {
+
+			for (end = begin + 1; end < num && block[end] == block[begin]; end++);
+
+			if (end - begin >= modeCount) {
+
+				mode      = block[begin];
+				modeCount = end - begin;
+			}
+		}
+
+		target(x, y, z) = mode;
+	});
+}
+
+// the pyramid datasets of intensities and labels
+void create(
+		VolumeStore&                store,
+		float,
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset,
+		int                         level) {
+
+	store.createIntensities(shape, resolution, offset, level);
+}
+
+void create(
+		VolumeStore&                store,
+		int,
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset,
+		int                         level) {
+
+	store.createLabels(shape, resolution, offset, level);
+}
+
+void save(VolumeStore& store, const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block, int level) {
+
+	store.saveIntensities(begin, block, level);
+}
+
+void save(VolumeStore& store, const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block, int level) {
+
+	store.saveLabels(begin, block, level);
+}
+
+} // anonymous namespace
+
+int
+getNumPyramidLevels() {
+
+	return optionPyramidLevels.as<int>();
+}
+
+template <typename ValueType>
+VolumePyramidBuilder<ValueType>::VolumePyramidBuilder(
+		VolumeStore&                store,
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset,
+		int                         numLevels) :
+	_store(store) {
+
+	// slices are stored in whole chunks, such that each chunk is compressed 
+	// only once
+	std::size_t chunkDepth = getHdf5ChunkShape()[2];
+	if (chunkDepth == 0)
+		chunkDepth = 64;
+
+	vigra::Shape3        levelShape      = shape;
+	util::point<float,3> levelResolution = resolution;
+
+	while (static_cast<int>(_levels.size()) < numLevels) {
+
+		if ((levelShape[0] + 1)/2 < 2 || (levelShape[1] + 1)/2 < 2 || (levelShape[2] + 1)/2 < 2)
+			break;
+
+		levelShape = vigra::Shape3(
+				(levelShape[0] + 1)/2,
+				(levelShape[1] + 1)/2,
+				(levelShape[2] + 1)/2);
+		levelResolution = util::point<float,3>(
+				levelResolution.x()*2,
+				levelResolution.y()*2,
+				levelResolution.z()*2);
+
+		int level = _levels.size() + 1;
+
+		LOG_USER(volumepyramidlog)
+				<< "creating level " << level << " of size "
+				<< levelShape << std::endl;
+
+		create(_store, ValueType(), levelShape, levelResolution, offset, level);
+
+		Level l;
+		l.shape      = levelShape;
+		l.haveCarry  = false;
+		l.numPending = 0;
+		l.begin      = 0;
+		l.pending.reshape(vigra::Shape3(
+				levelShape[0],
+				levelShape[1],
+				std::min<std::size_t>(chunkDepth, levelShape[2])));
+
+		_levels.push_back(l);
+	}
+}
+
+template <typename ValueType>
+void
+VolumePyramidBuilder<ValueType>::addSlab(const vigra::MultiArrayView<3, ValueType>& slab) {
+
+	add(0, slab);
+}
+
+template <typename ValueType>
+void
+VolumePyramidBuilder<ValueType>::finish() {
+
+	// a level receives slices only from the level before, so it is complete 
+	// once the carried slice of the level before was downsampled
+	for (std::size_t i = 0; i < _levels.size(); i++) {
+
+		if (_levels[i].haveCarry) {
+
+			_levels[i].haveCarry = false;
+			downsample(i, _levels[i].carry);
+		}
+
+		flush(i);
+	}
+}
+
+template <typename ValueType>
+void
+VolumePyramidBuilder<ValueType>::add(std::size_t i, const vigra::MultiArrayView<3, ValueType>& slices) {
+
+	if (i == _levels.size() || slices.shape(2) == 0)
+		return;
+
+	Level&        level = _levels[i];
+	vigra::Shape3 shape = slices.shape();
+	int           first = 0;
+
+	// complete the pair of the carried slice
+	if (level.haveCarry) {
+
+		vigra::MultiArray<3, ValueType> pair(vigra::Shape3(shape[0], shape[1], 2));
+		pair.template bind<2>(0) = level.carry.template bind<2>(0);
+		pair.template bind<2>(1) = slices.template bind<2>(0);
+
+		level.haveCarry = false;
+		downsample(i, pair);
+
+		first = 1;
+	}
+
+	int last = first + (shape[2] - first)/2*2;
+
+	if (last > first)
+		downsample(i, slices.subarray(vigra::Shape3(0, 0, first), vigra::Shape3(shape[0], shape[1], last)));
+
+	if (last < shape[2]) {
+
+		level.carry     = slices.subarray(vigra::Shape3(0, 0, last), shape);
+		level.haveCarry = true;
+	}
+}
+
+template <typename ValueType>
+void
+VolumePyramidBuilder<ValueType>::downsample(std::size_t i, const vigra::MultiArrayView<3, ValueType>& slices) {
+
+	Level& level = _levels[i];
+
+	vigra::MultiArray<3, ValueType> downsampled(vigra::Shape3(
+			level.shape[0],
+			level.shape[1],
+			(slices.shape(2) + 1)/2));
+	downsampleBlock(slices, downsampled);
+
+	// append to the pending slices, store them whenever a chunk is full
+	for (int z = 0; z < downsampled.shape(2);) {
+
+		int num = std::min<int>(
+				downsampled.shape(2) - z,
+				level.pending.shape(2) - level.numPending);
+
+		level.pending.subarray(
+				vigra::Shape3(0, 0, level.numPending),
+				vigra::Shape3(level.shape[0], level.shape[1], level.numPending + num)) =
+				downsampled.subarray(
+						vigra::Shape3(0, 0, z),
+						vigra::Shape3(level.shape[0], level.shape[1], z + num));
+
+		level.numPending += num;
+		z += num;
+
+		if (level.numPending == static_cast<std::size_t>(level.pending.shape(2)))
+			flush(i);
+	}
+
+	add(i + 1, downsampled);
+}
+
+template <typename ValueType>
+void
+VolumePyramidBuilder<ValueType>::flush(std::size_t i) {
+
+	Level& level = _levels[i];
+
+	if (level.numPending == 0)
+		return;
+
+	save(
+			_store,
+			vigra::Shape3(0, 0, level.begin),
+			level.pending.subarray(
+					vigra::Shape3(0, 0, 0),
+					vigra::Shape3(level.shape[0], level.shape[1], level.numPending)),
+			i + 1);
+
+	level.begin     += level.numPending;
+	level.numPending = 0;
+}
+
+template class VolumePyramidBuilder<float>;
+template class VolumePyramidBuilder<int>;
@@ -0,0 +1,94 @@
+#ifndef HOST_VOLUMES_VOLUME_PYRAMID_H__
+#define HOST_VOLUMES_VOLUME_PYRAMID_H__
+
+#include <vector>
+#include <imageprocessing/ExplicitVolume.h>
+#include <volumes/io/VolumeStore.h>
+
+/**
+ * The number of downsampled levels to store with new intensity and label 
+ * volumes, as set by the program option pyramidLevels.
+ */
+int getNumPyramidLevels();
+
+/**
+ * Builds the levels 1 to numLevels of a volume pyramid while the full 
+ * resolution volume is passed to it slab by slab, in z order. Each level is 
+ * computed from the slices of the previous one as they come in: two slices of 
+ * level l-1 give one slice of level l. Per level, only a slice waiting for 
+ * its partner and the slices not stored yet (at most one chunk deep, see 
+ * program option hdf5ChunkSize) are kept in memory. For all levels together, 
+ * this is a fraction of one chunk deep slab of the full resolution volume.
+ *
+ * For float volumes, each voxel of a level is the average of its block of 
+ * 2x2x2 voxels in the level before, and the levels are stored as the 
+ * intensity pyramid. For int volumes, each voxel gets the most frequent label 
+ * of its block (ties are broken in favour of the larger label), and the 
+ * levels are stored as the label pyramid. At the upper borders of volumes 
+ * with odd sizes, blocks contain fewer voxels.
+ */
+template <typename ValueType>
+class VolumePyramidBuilder {
+
+public:
+
+	/**
+	 * Create the levels of the pyramid for a volume of the given shape and 
+	 * geometry in the given store, where level l is downsampled by a factor of 
+	 * 2^l. Stops earlier, if a level would be smaller than two voxels in any 
+	 * dimension.
+	 */
+	VolumePyramidBuilder(
+			VolumeStore&                store,
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset,
+			int                         numLevels);
+
+	/**
+	 * Add the next slab of the full resolution volume.
+	 */
+	void addSlab(const vigra::MultiArrayView<3, ValueType>& slab);
+
+	/**
+	 * Store the remaining slices of all levels. Call this after the last slab 
+	 * was added.
+	 */
+	void finish();
+
+	/**
+	 * The number of levels created, not counting the full resolution.
+	 */
+	int getNumLevels() const { return _levels.size(); }
+
+private:
+
+	struct Level {
+
+		vigra::Shape3 shape;
+
+		// a slice of the previous level, waiting for its partner
+		vigra::MultiArray<3, ValueType> carry;
+		bool                            haveCarry;
+
+		// the slices of this level not stored yet, and where they start
+		vigra::MultiArray<3, ValueType> pending;
+		std::size_t                     numPending;
+		std::size_t                     begin;
+	};
+
+	// add slices of the level before _levels[i]
+	void add(std::size_t i, const vigra::MultiArrayView<3, ValueType>& slices);
+
+	// downsample an even number of slices (or the last one) into _levels[i]
+	void downsample(std::size_t i, const vigra::MultiArrayView<3, ValueType>& slices);
+
+	// store the pending slices of _levels[i]
+	void flush(std::size_t i);
+
+	VolumeStore&       _store;
+	std::vector<Level> _levels;
+};
+
+#endif // HOST_VOLUMES_VOLUME_PYRAMID_H__
+
@@ -0,0 +1,249 @@
+#include <fstream>
+#include <util/ProgramOptions.h>
+#include <util/exceptions.h>
+#include "Hdf5File.h"
+
+util::ProgramOption optionHdf5ChunkCache(
+		util::_long_name        = "hdf5ChunkCache",
+		util::_description_text = "The size of the HDF5 chunk cache per open dataset in MB.",
+		util::_default_value    = 64);
+
+util::ProgramOption optionHdf5ChunkSize(
+		util::_long_name        = "hdf5ChunkSize",
+		util::_description_text = "The edge length of the chunks of new volume datasets in voxels. Set to 0 to store volumes "
+		                          "contiguously (and uncompressed).",
+		util::_default_value    = 64);
+
+util::ProgramOption optionHdf5Compression(
+		util::_long_name        = "hdf5Compression",
+		util::_description_text = "The deflate compression level (0-9) of new chunked volume datasets.",
+		util::_default_value    = 1);
+
+vigra::HDF5HandleShared
+openHdf5File(const std::string& filename, bool readOnly) {
+
+	// a prime number of hash slots, much larger than the number of chunks 
+	// that fit in the cache
+	const std::size_t numSlots  = 10007;
+	const std::size_t cacheSize = optionHdf5ChunkCache.as<std::size_t>()*1024*1024;
+
+	hid_t access = H5Pcreate(H5P_FILE_ACCESS);
+	H5Pset_cache(access, 0, numSlots, cacheSize, 0.75);
+
+	hid_t file;
+	if (readOnly)
+		file = H5Fopen(filename.c_str(), H5F_ACC_RDONLY, access);
+	else if (std::ifstream(filename.c_str()).good())
+		file = H5Fopen(filename.c_str(), H5F_ACC_RDWR, access);
+	else
+		file = H5Fcreate(filename.c_str(), H5F_ACC_EXCL, H5P_DEFAULT, access);
+
+	H5Pclose(access);
+
+	if (file < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not open HDF5 file " << filename);
+
+	return vigra::HDF5HandleShared(file, &H5Fclose, "could not close HDF5 file");
+}
+
+vigra::Shape3
+getHdf5ChunkShape() {
+
+	int size = optionHdf5ChunkSize.as<int>();
+
+	return vigra::Shape3(size, size, size);
+}
+
+int
+getHdf5Compression() {
+
+	return optionHdf5Compression.as<int>();
+}
+
+hsize_t
+getHdf5DatasetSize(hid_t file, const std::string& path) {
+
+	if (H5Lexists(file, path.c_str(), H5P_DEFAULT) <= 0)
+		return 0;
+
+	vigra::HDF5Handle dataset(H5Dopen2(file, path.c_str(), H5P_DEFAULT), &H5Dclose, "could not open dataset");
+	vigra::HDF5Handle space(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+
+	hsize_t size;
+	H5Sget_simple_extent_dims(space, &size, NULL);
+
+	return size;
+}
+
+void
+resizeHdf5Dataset(hid_t file, const std::string& path, hsize_t size) {
+
+	if (H5Lexists(file, path.c_str(), H5P_DEFAULT) <= 0)
+		return;
+
+	vigra::HDF5Handle dataset(H5Dopen2(file, path.c_str(), H5P_DEFAULT), &H5Dclose, "could not open dataset");
+
+	if (H5Dset_extent(dataset, &size) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not resize dataset " << path);
+}
+
+hsize_t
+appendToHdf5Dataset(hid_t file, const std::string& path, hid_t type, const void* values, hsize_t size) {
+
+	// elements per chunk
+	const hsize_t chunkSize = 16*1024;
+
+	if (H5Lexists(file, path.c_str(), H5P_DEFAULT) <= 0) {
+
+		hsize_t dims    = 0;
+		hsize_t maxDims = H5S_UNLIMITED;
+
+		vigra::HDF5Handle properties(H5Pcreate(H5P_DATASET_CREATE), &H5Pclose, "could not create property list");
+		H5Pset_chunk(properties, 1, &chunkSize);
+		if (getHdf5Compression() > 0)
+			H5Pset_deflate(properties, getHdf5Compression());
+
+		vigra::HDF5Handle space(H5Screate_simple(1, &dims, &maxDims), &H5Sclose, "could not create dataspace");
+		vigra::HDF5Handle dataset(
+				H5Dcreate2(file, path.c_str(), type, space, H5P_DEFAULT, properties, H5P_DEFAULT),
+				&H5Dclose,
+				"could not create dataset");
+	}
+
+	vigra::HDF5Handle dataset(H5Dopen2(file, path.c_str(), H5P_DEFAULT), &H5Dclose, "could not open dataset");
+
+	hsize_t start;
+	{
+		vigra::HDF5Handle space(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+		H5Sget_simple_extent_dims(space, &start, NULL);
+	}
+
+	if (size == 0)
+		return start;
+
+	hsize_t newSize = start + size;
+	if (H5Dset_extent(dataset, &newSize) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not extend dataset " << path);
+
+	vigra::HDF5Handle fileSpace(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+	vigra::HDF5Handle memSpace(H5Screate_simple(1, &size, NULL), &H5Sclose, "could not create dataspace");
+	H5Sselect_hyperslab(fileSpace, H5S_SELECT_SET, &start, NULL, &size, NULL);
+
+	if (H5Dwrite(dataset, type, memSpace, fileSpace, H5P_DEFAULT, values) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not write to dataset " << path);
+
+	return start;
+}
+
+void
+readHdf5Ranges(hid_t file, const std::string& path, const Hdf5Ranges& ranges, hid_t type, void* values) {
+
+	vigra::HDF5Handle dataset(H5Dopen2(file, path.c_str(), H5P_DEFAULT), &H5Dclose, "could not open dataset");
+	vigra::HDF5Handle fileSpace(H5Dget_space(dataset), &H5Sclose, "could not get dataspace");
+
+	H5Sselect_none(fileSpace);
+
+	hsize_t size = 0;
+	std::size_t i = 0;
+	while (i < ranges.size()) {
+
+		// merge adjacent ranges into one hyperslab
+		hsize_t start = ranges[i].first;
+		hsize_t count = ranges[i].second;
+		for (i++; i < ranges.size() && ranges[i].first == start + count; i++)
+			count += ranges[i].second;
+
+		if (count > 0)
+			H5Sselect_hyperslab(fileSpace, H5S_SELECT_OR, &start, NULL, &count, NULL);
+
+		size += count;
+	}
+
+	if (size == 0)
+		return;
+
+	vigra::HDF5Handle memSpace(H5Screate_simple(1, &size, NULL), &H5Sclose, "could not create dataspace");
+
+	if (H5Dread(dataset, type, memSpace, fileSpace, H5P_DEFAULT, values) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not read from dataset " << path);
+}
+
+void
+setHdf5StageComplete(hid_t file, const std::string& stage, const std::string& stamp) {
+
+	// the results of the stage are on disk before the mark
+	H5Fflush(file, H5F_SCOPE_GLOBAL);
+
+	clearHdf5StageComplete(file, stage);
+
+	std::string name = stage + "_complete";
+
+	vigra::HDF5Handle root(H5Gopen2(file, "/", H5P_DEFAULT), &H5Gclose, "could not open root group");
+	vigra::HDF5Handle type(H5Tcopy(H5T_C_S1), &H5Tclose, "could not create string type");
+	H5Tset_size(type, H5T_VARIABLE);
+
+	vigra::HDF5Handle space(H5Screate(H5S_SCALAR), &H5Sclose, "could not create dataspace");
+	vigra::HDF5Handle attribute(
+			H5Acreate2(root, name.c_str(), type, space, H5P_DEFAULT, H5P_DEFAULT),
+			&H5Aclose,
+			"could not create attribute");
+
+	const char* data = stamp.c_str();
+	if (H5Awrite(attribute, type, &data) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not mark stage " << stage << " as complete");
+
+	H5Fflush(file, H5F_SCOPE_GLOBAL);
+}
+
+bool
+isHdf5StageComplete(hid_t file, const std::string& stage, const std::string& stamp) {
+
+	std::string name = stage + "_complete";
+
+	vigra::HDF5Handle root(H5Gopen2(file, "/", H5P_DEFAULT), &H5Gclose, "could not open root group");
+
+	if (H5Aexists(root, name.c_str()) <= 0)
+		return false;
+
+	vigra::HDF5Handle attribute(H5Aopen(root, name.c_str(), H5P_DEFAULT), &H5Aclose, "could not open attribute");
+	vigra::HDF5Handle space(H5Aget_space(attribute), &H5Sclose, "could not get dataspace");
+	vigra::HDF5Handle type(H5Tcopy(H5T_C_S1), &H5Tclose, "could not create string type");
+	H5Tset_size(type, H5T_VARIABLE);
+
+	char* data = NULL;
+	if (H5Aread(attribute, type, &data) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not read completion mark of stage " << stage);
+
+	bool complete = (data != NULL && stamp == data);
+
+	H5Dvlen_reclaim(type, space, H5P_DEFAULT, &data);
+
+	return complete;
+}
+
+void
+clearHdf5StageComplete(hid_t file, const std::string& stage) {
+
+	std::string name = stage + "_complete";
+
+	vigra::HDF5Handle root(H5Gopen2(file, "/", H5P_DEFAULT), &H5Gclose, "could not open root group");
+
+	if (H5Aexists(root, name.c_str()) > 0 && H5Adelete(root, name.c_str()) < 0)
+		UTIL_THROW_EXCEPTION(
+				IOError,
+				"could not remove completion mark of stage " << stage);
+}
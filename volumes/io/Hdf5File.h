@@ -0,0 +1,108 @@
+#ifndef HOST_VOLUMES_IO_HDF5_FILE_H__
+#define HOST_VOLUMES_IO_HDF5_FILE_H__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <vigra/hdf5impex.hxx>
+
+/**
+ * Open an HDF5 file (or create it, if it does not exist and readOnly is 
+ * false) with a raw data chunk cache of the size given by the program option 
+ * hdf5ChunkCache. Pass the result to the vigra::HDF5File constructor.
+ */
+vigra::HDF5HandleShared openHdf5File(const std::string& filename, bool readOnly = false);
+
+/**
+ * The chunk shape for new volume datasets, as set by the program option 
+ * hdf5ChunkSize. All zero, if datasets should be stored contiguously.
+ */
+vigra::Shape3 getHdf5ChunkShape();
+
+/**
+ * The deflate compression level (0-9) for new volume datasets, as set by the 
+ * program option hdf5Compression.
+ */
+int getHdf5Compression();
+
+/**
+ * The native HDF5 type for a C++ type.
+ */
+template <typename T> hid_t hdf5NativeType();
+template <> inline hid_t hdf5NativeType<int>()       { return H5T_NATIVE_INT; }
+template <> inline hid_t hdf5NativeType<long long>() { return H5T_NATIVE_LLONG; }
+template <> inline hid_t hdf5NativeType<float>()     { return H5T_NATIVE_FLOAT; }
+template <> inline hid_t hdf5NativeType<double>()    { return H5T_NATIVE_DOUBLE; }
+
+/**
+ * Half-open ranges [first, first + second) of elements in a one-dimensional 
+ * dataset.
+ */
+typedef std::vector<std::pair<hsize_t, hsize_t>> Hdf5Ranges;
+
+/**
+ * The number of elements of a one-dimensional dataset, 0 if it does not 
+ * exist.
+ */
+hsize_t getHdf5DatasetSize(hid_t file, const std::string& path);
+
+/**
+ * Shrink or grow a one-dimensional, chunked dataset to the given size, if it 
+ * exists.
+ */
+void resizeHdf5Dataset(hid_t file, const std::string& path, hsize_t size);
+
+/**
+ * Append values to a one-dimensional, chunked dataset with unlimited size, 
+ * which is created if it does not exist. The parent group has to exist. 
+ * Returns the size of the dataset before appending.
+ */
+hsize_t appendToHdf5Dataset(hid_t file, const std::string& path, hid_t type, const void* values, hsize_t size);
+
+template <typename T>
+hsize_t appendToHdf5Dataset(hid_t file, const std::string& path, const std::vector<T>& values) {
+
+	return appendToHdf5Dataset(file, path, hdf5NativeType<T>(), values.data(), values.size());
+}
+
+/**
+ * Read the given ranges of a one-dimensional dataset with a single read. The 
+ * ranges have to be sorted and must not overlap. The values of all ranges 
+ * are stored one after the other in values.
+ */
+void readHdf5Ranges(hid_t file, const std::string& path, const Hdf5Ranges& ranges, hid_t type, void* values);
+
+template <typename T>
+void readHdf5Ranges(hid_t file, const std::string& path, const Hdf5Ranges& ranges, std::vector<T>& values) {
+
+	hsize_t size = 0;
+	for (auto& range : ranges)
+		size += range.second;
+
+	values.resize(size);
+
+	if (size > 0)
+		readHdf5Ranges(file, path, ranges, hdf5NativeType<T>(), values.data());
+}
+
+/**
+ * Mark a processing stage of a project file as complete, with an attribute 
+ * "<stage>_complete" of the root group. Call this after all results of the 
+ * stage were written, such that an interrupted stage is never taken as 
+ * complete. The stamp identifies the inputs the stage was run on.
+ */
+void setHdf5StageComplete(hid_t file, const std::string& stage, const std::string& stamp = "");
+
+/**
+ * Whether the given stage was marked complete with the given stamp.
+ */
+bool isHdf5StageComplete(hid_t file, const std::string& stage, const std::string& stamp = "");
+
+/**
+ * Remove the completion mark of a stage. Call this before the stage changes 
+ * any of its results.
+ */
+void clearHdf5StageComplete(hid_t file, const std::string& stage);
+
+#endif // HOST_VOLUMES_IO_HDF5_FILE_H__
+
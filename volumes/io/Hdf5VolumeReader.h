@@ -2,7 +2,10 @@
 #define HOST_VOLUMES_IO_HDF5_VOLUME_READER_H__
 
 #include <string>
+#include <cmath>
+#include <algorithm>
 #include <vigra/hdf5impex.hxx>
+#include <util/exceptions.h>
 #include <imageprocessing/ExplicitVolume.h>
 
 class Hdf5VolumeReader {
@@ -18,8 +21,13 @@ protected:
 	void readVolume(ExplicitVolume<ValueType>& volume, std::string dataset, bool onlyGeometry = false) {
 
 		// the volume
-		if (!onlyGeometry)
-			_hdfFile.readAndResize(dataset, volume.data());
+		if (!onlyGeometry) {
+
+			if (_hdfFile.existsAttribute(dataset, "packed_shape"))
+				readMask(volume, dataset);
+			else
+				_hdfFile.readAndResize(dataset, volume.data());
+		}
 
 		vigra::MultiArray<1, float> p(3);
 
@@ -38,8 +46,117 @@ protected:
 		volume.setOffset(p[0], p[1], p[2]);
 	}
 
+	/**
+	 * Read only the block [begin,end) of a volume dataset, using a hyperslab 
+	 * selection. The offset of the volume is set to the position of the block.
+	 */
+	template <typename ValueType>
+	void readVolumeBlock(
+			ExplicitVolume<ValueType>& volume,
+			std::string dataset,
+			const vigra::Shape3& begin,
+			const vigra::Shape3& end) {
+
+		if (_hdfFile.existsAttribute(dataset, "packed_shape"))
+			UTIL_THROW_EXCEPTION(
+					NotYetImplemented,
+					"block reads of bit-packed volumes are not supported");
+
+		readVolume(volume, dataset, true);
+
+		volume.data().reshape(end - begin);
+		_hdfFile.readBlock(dataset, begin, end - begin, volume.data());
+
+		volume.setOffset(
+				volume.getOffset() +
+				util::point<float,3>(begin[0], begin[1], begin[2])*volume.getResolution());
+	}
+
+	/**
+	 * Read only the part of a volume dataset that intersects the given 
+	 * bounding box (in world units), using a hyperslab selection. The offset 
+	 * of the volume is set to the position of the first voxel read. If the 
+	 * bounding box does not intersect the volume, the volume will be empty.
+	 */
+	template <typename ValueType>
+	void readVolumeRegion(
+			ExplicitVolume<ValueType>& volume,
+			std::string dataset,
+			const util::box<float,3>& region) {
+
+		readVolume(volume, dataset, true);
+
+		vigra::Shape3 shape = getVolumeShape(dataset);
+
+		float offset[3]     = { volume.getOffset().x(), volume.getOffset().y(), volume.getOffset().z() };
+		float resolution[3] = { volume.getResolutionX(), volume.getResolutionY(), volume.getResolutionZ() };
+
+		// all voxels that are at least partially inside the region
+		vigra::Shape3 begin, end;
+		for (int d = 0; d < 3; d++) {
+
+			begin[d] = std::floor((region.min()[d] - offset[d])/resolution[d]);
+			end[d]   = std::ceil((region.max()[d] - offset[d])/resolution[d]);
+
+			begin[d] = std::min(std::max(begin[d], vigra::MultiArrayIndex(0)), shape[d]);
+			end[d]   = std::min(std::max(end[d], begin[d]), shape[d]);
+		}
+
+		if (vigra::prod(end - begin) == 0) {
+
+			volume.data().reshape(vigra::Shape3(0, 0, 0));
+			return;
+		}
+
+		readVolumeBlock(volume, dataset, begin, end);
+	}
+
+	/**
+	 * Get the shape of a volume dataset without reading it. For bit-packed 
+	 * volumes, this is the shape of the unpacked volume.
+	 */
+	vigra::Shape3 getVolumeShape(std::string dataset) {
+
+		if (_hdfFile.existsAttribute(dataset, "packed_shape")) {
+
+			vigra::MultiArray<1, int> shape(3);
+			_hdfFile.readAttribute(
+					dataset,
+					"packed_shape",
+					shape);
+
+			return vigra::Shape3(shape[0], shape[1], shape[2]);
+		}
+
+		vigra::ArrayVector<hsize_t> shape = _hdfFile.getDatasetShape(dataset);
+
+		return vigra::Shape3(shape[0], shape[1], shape[2]);
+	}
+
 private:
 
+	// read a volume written with Hdf5VolumeWriter::writeMask()
+	template <typename ValueType>
+	void readMask(ExplicitVolume<ValueType>& volume, std::string dataset) {
+
+		vigra::MultiArray<1, int> shape(3);
+		_hdfFile.readAttribute(
+				dataset,
+				"packed_shape",
+				shape);
+
+		vigra::MultiArray<3, unsigned char> packed;
+		_hdfFile.readAndResize(dataset, packed);
+
+		vigra::MultiArray<3, ValueType>& data = volume.data();
+		data.reshape(vigra::Shape3(shape[0], shape[1], shape[2]));
+
+		for (int z = 0; z < shape[2]; z++)
+		for (int y = 0; y < shape[1]; y++)
+		for (int x = 0; x < shape[0]; x++)
+			data(x, y, z) = (packed(x/8, y, z) >> (x%8)) & 1;
+	}
+
 	vigra::HDF5File& _hdfFile;
 };
 
@@ -1,3 +1,4 @@
+#include <boost/lexical_cast.hpp>
 #include "Hdf5VolumeStore.h"
 
 void
@@ -18,6 +19,146 @@ Hdf5VolumeStore::saveLabels(const ExplicitVolume<int>& labels) {
 	writeVolume(labels, "labels");
 }
 
+void
+Hdf5VolumeStore::createIntensities(
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset) {
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+
+	createVolume<float>("intensities", shape, resolution, offset);
+}
+
+void
+Hdf5VolumeStore::saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block) {
+
+	_hdfFile.cd("/volumes");
+	writeVolumeBlock("intensities", begin, block);
+}
+
+void
+Hdf5VolumeStore::createLabels(
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset) {
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+
+	createVolume<int>("labels", shape, resolution, offset);
+}
+
+void
+Hdf5VolumeStore::saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block) {
+
+	_hdfFile.cd("/volumes");
+	writeVolumeBlock("labels", begin, block);
+}
+
+void
+Hdf5VolumeStore::saveIntensities(const ExplicitVolume<float>& intensities, int level) {
+
+	if (level == 0) {
+
+		saveIntensities(intensities);
+		return;
+	}
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+	_hdfFile.cd_mk("pyramid");
+	_hdfFile.cd_mk(boost::lexical_cast<std::string>(level));
+
+	writeVolume(intensities, "intensities");
+}
+
+void
+Hdf5VolumeStore::saveLabels(const ExplicitVolume<int>& labels, int level) {
+
+	if (level == 0) {
+
+		saveLabels(labels);
+		return;
+	}
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+	_hdfFile.cd_mk("pyramid");
+	_hdfFile.cd_mk(boost::lexical_cast<std::string>(level));
+
+	writeVolume(labels, "labels");
+}
+
+void
+Hdf5VolumeStore::createIntensities(
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset,
+		int                         level) {
+
+	if (level == 0) {
+
+		createIntensities(shape, resolution, offset);
+		return;
+	}
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+	_hdfFile.cd_mk("pyramid");
+	_hdfFile.cd_mk(boost::lexical_cast<std::string>(level));
+
+	createVolume<float>("intensities", shape, resolution, offset);
+}
+
+void
+Hdf5VolumeStore::saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block, int level) {
+
+	if (level == 0) {
+
+		saveIntensities(begin, block);
+		return;
+	}
+
+	_hdfFile.cd(levelGroup(level));
+	writeVolumeBlock("intensities", begin, block);
+}
+
+void
+Hdf5VolumeStore::createLabels(
+		const vigra::Shape3&        shape,
+		const util::point<float,3>& resolution,
+		const util::point<float,3>& offset,
+		int                         level) {
+
+	if (level == 0) {
+
+		createLabels(shape, resolution, offset);
+		return;
+	}
+
+	_hdfFile.root();
+	_hdfFile.cd_mk("volumes");
+	_hdfFile.cd_mk("pyramid");
+	_hdfFile.cd_mk(boost::lexical_cast<std::string>(level));
+
+	createVolume<int>("labels", shape, resolution, offset);
+}
+
+void
+Hdf5VolumeStore::saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block, int level) {
+
+	if (level == 0) {
+
+		saveLabels(begin, block);
+		return;
+	}
+
+	_hdfFile.cd(levelGroup(level));
+	writeVolumeBlock("labels", begin, block);
+}
+
 void
 Hdf5VolumeStore::retrieveIntensities(ExplicitVolume<float>& intensities) {
 
@@ -31,3 +172,94 @@ Hdf5VolumeStore::retrieveLabels(ExplicitVolume<int>& labels) {
 	_hdfFile.cd("/volumes");
 	readVolume(labels, "labels");
 }
+
+void
+Hdf5VolumeStore::retrieveIntensities(const util::box<float,3>& boundingBox, ExplicitVolume<float>& intensities) {
+
+	_hdfFile.cd("/volumes");
+	readVolumeRegion(intensities, "intensities", boundingBox);
+}
+
+void
+Hdf5VolumeStore::retrieveLabels(const util::box<float,3>& boundingBox, ExplicitVolume<int>& labels) {
+
+	_hdfFile.cd("/volumes");
+	readVolumeRegion(labels, "labels", boundingBox);
+}
+
+int
+Hdf5VolumeStore::getNumLevels() {
+
+	int level = 1;
+	while (
+			_hdfFile.existsDataset(levelGroup(level) + "/intensities") &&
+			_hdfFile.existsDataset(levelGroup(level) + "/labels"))
+		level++;
+
+	return level;
+}
+
+int
+Hdf5VolumeStore::getLevel(const util::point<float,3>& resolution) {
+
+	vigra::MultiArray<1, float> p(3);
+
+	for (int level = getNumLevels() - 1; level > 0; level--) {
+
+		_hdfFile.readAttribute(
+				levelGroup(level) + "/intensities",
+				"resolution",
+				p);
+
+		if (p[0] <= resolution.x() && p[1] <= resolution.y() && p[2] <= resolution.z())
+			return level;
+	}
+
+	return 0;
+}
+
+void
+Hdf5VolumeStore::retrieveIntensities(int level, ExplicitVolume<float>& intensities) {
+
+	if (level == 0) {
+
+		retrieveIntensities(intensities);
+		return;
+	}
+
+	_hdfFile.cd(levelGroup(level));
+	readVolume(intensities, "intensities");
+}
+
+void
+Hdf5VolumeStore::retrieveLabels(int level, ExplicitVolume<int>& labels) {
+
+	if (level == 0) {
+
+		retrieveLabels(labels);
+		return;
+	}
+
+	_hdfFile.cd(levelGroup(level));
+	readVolume(labels, "labels");
+}
+
+vigra::Shape3
+Hdf5VolumeStore::getLabelsShape() {
+
+	_hdfFile.cd("/volumes");
+	return getVolumeShape("labels");
+}
+
+void
+Hdf5VolumeStore::retrieveLabels(const vigra::Shape3& begin, const vigra::Shape3& end, ExplicitVolume<int>& labels) {
+
+	_hdfFile.cd("/volumes");
+	readVolumeBlock(labels, "labels", begin, end);
+}
+
+std::string
+Hdf5VolumeStore::levelGroup(int level) {
+
+	return "/volumes/pyramid/" + boost::lexical_cast<std::string>(level);
+}
@@ -2,6 +2,7 @@
 #define HOST_TUBES_IO_HDF5_VOLUME_STORE_H__
 
 #include "VolumeStore.h"
+#include "Hdf5File.h"
 #include "Hdf5VolumeReader.h"
 #include "Hdf5VolumeWriter.h"
 
@@ -9,23 +10,81 @@ class Hdf5VolumeStore : public VolumeStore, public Hdf5VolumeReader, public Hdf5
 
 public:
 
-	Hdf5VolumeStore(std::string projectFile) :
+	/**
+	 * Open the volume store in the given project file. A read-only store can 
+	 * be opened by several processes at the same time.
+	 */
+	Hdf5VolumeStore(std::string projectFile, bool readOnly = false) :
 		Hdf5VolumeReader(_hdfFile),
 		Hdf5VolumeWriter(_hdfFile),
-		_hdfFile(
-				projectFile,
-				vigra::HDF5File::OpenMode::ReadWrite) {}
+		_hdfFile(openHdf5File(projectFile, readOnly), "", readOnly) {}
 
 	void saveIntensities(const ExplicitVolume<float>& intensities) override;
 
 	void saveLabels(const ExplicitVolume<int>& labels) override;
 
+	void createIntensities(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) override;
+
+	void saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block) override;
+
+	void createLabels(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) override;
+
+	void saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block) override;
+
+	/**
+	 * Levels of the volume pyramid are stored in groups /volumes/pyramid/<level>.
+	 */
+	void saveIntensities(const ExplicitVolume<float>& intensities, int level) override;
+
+	void saveLabels(const ExplicitVolume<int>& labels, int level) override;
+
+	void createIntensities(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset,
+			int                         level) override;
+
+	void saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block, int level) override;
+
+	void createLabels(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset,
+			int                         level) override;
+
+	void saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block, int level) override;
+
 	void retrieveIntensities(ExplicitVolume<float>& intensities) override;
 
 	void retrieveLabels(ExplicitVolume<int>& labels) override;
 
+	void retrieveIntensities(const util::box<float,3>& boundingBox, ExplicitVolume<float>& intensities) override;
+
+	void retrieveLabels(const util::box<float,3>& boundingBox, ExplicitVolume<int>& labels) override;
+
+	int getNumLevels() override;
+
+	int getLevel(const util::point<float,3>& resolution) override;
+
+	void retrieveIntensities(int level, ExplicitVolume<float>& intensities) override;
+
+	void retrieveLabels(int level, ExplicitVolume<int>& labels) override;
+
+	vigra::Shape3 getLabelsShape() override;
+
+	void retrieveLabels(const vigra::Shape3& begin, const vigra::Shape3& end, ExplicitVolume<int>& labels) override;
+
 private:
 
+	// the group of a level of the volume pyramid
+	std::string levelGroup(int level);
+
 	vigra::HDF5File _hdfFile;
 };
 
@@ -4,13 +4,28 @@
 #include <string>
 #include <vigra/hdf5impex.hxx>
 #include <imageprocessing/ExplicitVolume.h>
+#include "Hdf5File.h"
 
 class Hdf5VolumeWriter {
 
 public:
 
 	Hdf5VolumeWriter(vigra::HDF5File& hdfFile) :
-		_hdfFile(hdfFile) {}
+		_hdfFile(hdfFile),
+		_chunkShape(getHdf5ChunkShape()),
+		_compression(getHdf5Compression()) {}
+
+	/**
+	 * Set the chunk shape for datasets written from now on. Set to all zeros
+	 * to store datasets contiguously.
+	 */
+	void setChunkShape(const vigra::Shape3& chunkShape) { _chunkShape = chunkShape; }
+
+	/**
+	 * Set the deflate compression level (0-9) for chunked datasets written
+	 * from now on.
+	 */
+	void setCompression(int compression) { _compression = compression; }
 
 protected:
 
@@ -18,34 +33,134 @@ protected:
 	void writeVolume(const ExplicitVolume<ValueType>& volume, std::string dataset) {
 
 		// the volume
-		_hdfFile.write(
+		writeArray(dataset, volume.data());
+
+		writeGeometry(volume, dataset);
+	}
+
+	/**
+	 * Write a binary volume with one bit per voxel, packed along x. Use
+	 * Hdf5VolumeReader::readVolume() to read it again.
+	 */
+	template <typename ValueType>
+	void writeMask(const ExplicitVolume<ValueType>& volume, std::string dataset) {
+
+		const vigra::MultiArray<3, ValueType>& data = volume.data();
+
+		vigra::MultiArray<3, unsigned char> packed(
+				vigra::Shape3((data.shape(0) + 7)/8, data.shape(1), data.shape(2)));
+
+		for (int z = 0; z < data.shape(2); z++)
+		for (int y = 0; y < data.shape(1); y++)
+		for (int x = 0; x < data.shape(0); x++)
+			if (data(x, y, z))
+				packed(x/8, y, z) |= (1 << (x%8));
+
+		writeArray(dataset, packed);
+
+		// the shape of the unpacked volume
+		vigra::MultiArray<1, int> shape(3);
+		for (int d = 0; d < 3; d++)
+			shape[d] = data.shape(d);
+		_hdfFile.writeAttribute(
+				dataset,
+				"packed_shape",
+				shape);
+
+		writeGeometry(volume, dataset);
+	}
+
+	/**
+	 * Create a dataset for a volume of the given shape and geometry, with the 
+	 * current chunk shape and compression. Use writeVolumeBlock() to fill it.
+	 */
+	template <typename ValueType>
+	void createVolume(
+			std::string                 dataset,
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) {
+
+		vigra::Shape3 chunkShape(0, 0, 0);
+		if (_chunkShape != vigra::Shape3(0, 0, 0))
+			chunkShape = vigra::max(vigra::min(_chunkShape, shape), vigra::Shape3(1, 1, 1));
+
+		_hdfFile.createDataset<3, ValueType>(
 				dataset,
-				volume.data());
+				shape,
+				ValueType(),
+				chunkShape,
+				(chunkShape == vigra::Shape3(0, 0, 0) ? 0 : _compression));
+
+		writeGeometry(dataset, resolution, offset);
+	}
+
+	/**
+	 * Write a block of a volume dataset created with createVolume(), starting 
+	 * at the given voxel.
+	 */
+	template <typename ValueType>
+	void writeVolumeBlock(
+			std::string                                dataset,
+			const vigra::Shape3&                       begin,
+			const vigra::MultiArrayView<3, ValueType>& block) {
+
+		_hdfFile.writeBlock(dataset, begin, block);
+	}
+
+private:
+
+	template <typename ValueType>
+	void writeArray(std::string dataset, const vigra::MultiArray<3, ValueType>& data) {
+
+		if (_chunkShape == vigra::Shape3(0, 0, 0) || data.size() == 0) {
+
+			_hdfFile.write(dataset, data);
+			return;
+		}
+
+		// chunks can not be larger than the dataset
+		vigra::Shape3 chunkShape = vigra::max(vigra::min(_chunkShape, data.shape()), vigra::Shape3(1, 1, 1));
+
+		_hdfFile.write(dataset, data, chunkShape, _compression);
+	}
+
+	template <typename ValueType>
+	void writeGeometry(const ExplicitVolume<ValueType>& volume, std::string dataset) {
+
+		writeGeometry(dataset, volume.getResolution(), volume.getOffset());
+	}
+
+	void writeGeometry(
+			std::string                 dataset,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) {
 
 		vigra::MultiArray<1, float> p(3);
 
 		// resolution
-		p[0] = volume.getResolutionX();
-		p[1] = volume.getResolutionY();
-		p[2] = volume.getResolutionZ();
+		p[0] = resolution.x();
+		p[1] = resolution.y();
+		p[2] = resolution.z();
 		_hdfFile.writeAttribute(
 				dataset,
 				"resolution",
 				p);
 
 		// offset
-		p[0] = volume.getOffset().x();
-		p[1] = volume.getOffset().y();
-		p[2] = volume.getOffset().z();
+		p[0] = offset.x();
+		p[1] = offset.y();
+		p[2] = offset.z();
 		_hdfFile.writeAttribute(
 				dataset,
 				"offset",
 				p);
 	}
 
-private:
-
 	vigra::HDF5File& _hdfFile;
+
+	vigra::Shape3 _chunkShape;
+	int           _compression;
 };
 
 #endif // HOST_VOLUMES_IO_HDF5_VOLUME_WRITER_H__
@@ -20,6 +20,83 @@ public:
 	 */
 	virtual void saveLabels(const ExplicitVolume<int>& labels) = 0;
 
+	/**
+	 * Create an empty intensity volume of the given shape (in voxels) and 
+	 * geometry, to be filled block by block with saveIntensities(begin, 
+	 * block). Replaces the intensity volume stored so far.
+	 */
+	virtual void createIntensities(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) = 0;
+
+	/**
+	 * Store a block of the intensity volume created with createIntensities(), 
+	 * starting at the given voxel.
+	 */
+	virtual void saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block) = 0;
+
+	/**
+	 * Create an empty label volume of the given shape (in voxels) and 
+	 * geometry, to be filled block by block with saveLabels(begin, block). 
+	 * Replaces the label volume stored so far.
+	 */
+	virtual void createLabels(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset) = 0;
+
+	/**
+	 * Store a block of the label volume created with createLabels(), starting 
+	 * at the given voxel.
+	 */
+	virtual void saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block) = 0;
+
+	/**
+	 * Store a downsampled intensity volume as the given level of the volume 
+	 * pyramid. Level 0 is the volume stored with saveIntensities(intensities).
+	 */
+	virtual void saveIntensities(const ExplicitVolume<float>& intensities, int level) = 0;
+
+	/**
+	 * Store a downsampled label volume as the given level of the volume 
+	 * pyramid. Level 0 is the volume stored with saveLabels(labels).
+	 */
+	virtual void saveLabels(const ExplicitVolume<int>& labels, int level) = 0;
+
+	/**
+	 * Create an empty intensity volume for the given level of the volume 
+	 * pyramid, to be filled block by block with saveIntensities(begin, block, 
+	 * level).
+	 */
+	virtual void createIntensities(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset,
+			int                         level) = 0;
+
+	/**
+	 * Store a block of the intensity volume of the given level of the volume 
+	 * pyramid, starting at the given voxel.
+	 */
+	virtual void saveIntensities(const vigra::Shape3& begin, const vigra::MultiArrayView<3, float>& block, int level) = 0;
+
+	/**
+	 * Create an empty label volume for the given level of the volume pyramid, 
+	 * to be filled block by block with saveLabels(begin, block, level).
+	 */
+	virtual void createLabels(
+			const vigra::Shape3&        shape,
+			const util::point<float,3>& resolution,
+			const util::point<float,3>& offset,
+			int                         level) = 0;
+
+	/**
+	 * Store a block of the label volume of the given level of the volume 
+	 * pyramid, starting at the given voxel.
+	 */
+	virtual void saveLabels(const vigra::Shape3& begin, const vigra::MultiArrayView<3, int>& block, int level) = 0;
+
 	/**
 	 * Get the intensity volume.
 	 */
@@ -29,6 +106,53 @@ public:
 	 * Get the label volume.
 	 */
 	virtual void retrieveLabels(ExplicitVolume<int>& labels) = 0;
+
+	/**
+	 * Get the part of the intensity volume that intersects the given bounding 
+	 * box (in world units). The offset of the returned volume is set to the 
+	 * position of the first voxel read.
+	 */
+	virtual void retrieveIntensities(const util::box<float,3>& boundingBox, ExplicitVolume<float>& intensities) = 0;
+
+	/**
+	 * Get the part of the label volume that intersects the given bounding box 
+	 * (in world units). The offset of the returned volume is set to the 
+	 * position of the first voxel read.
+	 */
+	virtual void retrieveLabels(const util::box<float,3>& boundingBox, ExplicitVolume<int>& labels) = 0;
+
+	/**
+	 * The number of levels of the volume pyramid, including the full 
+	 * resolution level 0.
+	 */
+	virtual int getNumLevels() = 0;
+
+	/**
+	 * Get the coarsest level of the volume pyramid with a resolution at least 
+	 * as fine as the given one in each dimension, or 0 if there is none.
+	 */
+	virtual int getLevel(const util::point<float,3>& resolution) = 0;
+
+	/**
+	 * Get the intensity volume of the given level of the volume pyramid.
+	 */
+	virtual void retrieveIntensities(int level, ExplicitVolume<float>& intensities) = 0;
+
+	/**
+	 * Get the label volume of the given level of the volume pyramid.
+	 */
+	virtual void retrieveLabels(int level, ExplicitVolume<int>& labels) = 0;
+
+	/**
+	 * Get the shape of the label volume in voxels, without reading it.
+	 */
+	virtual vigra::Shape3 getLabelsShape() = 0;
+
+	/**
+	 * Get the block [begin,end) (in voxels) of the label volume. The offset of 
+	 * the returned volume is set to the position of the block.
+	 */
+	virtual void retrieveLabels(const vigra::Shape3& begin, const vigra::Shape3& end, ExplicitVolume<int>& labels) = 0;
 };
 
 